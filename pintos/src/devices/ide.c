@@ -90,6 +90,7 @@ static void issue_pio_command (struct channel *, uint8_t command);
 static void input_sector (struct channel *, void *);
 static void output_sector (struct channel *, const void *);
 
+static void wait_for_completion (const struct ata_disk *);
 static void wait_until_idle (const struct ata_disk *);
 static bool wait_while_busy (const struct ata_disk *);
 static void select_device (const struct ata_disk *);
@@ -123,7 +124,7 @@ ide_init (void)
         default:
           NOT_REACHED ();
         }
-      lock_init (&c->lock);
+      lock_init_named (&c->lock, c->name);
       c->expecting_interrupt = false;
       sema_init (&c->completion_wait, 0);
  
@@ -349,7 +350,7 @@ ide_read (void *d_, block_sector_t sec_no, void *buffer)
   lock_acquire (&c->lock);
   select_sector (d, sec_no);
   issue_pio_command (c, CMD_READ_SECTOR_RETRY);
-  sema_down (&c->completion_wait);
+  wait_for_completion (d);
   if (!wait_while_busy (d))
     PANIC ("%s: disk read failed, sector=%"PRDSNu, d->name, sec_no);
   input_sector (c, buffer);
@@ -372,7 +373,12 @@ ide_write (void *d_, block_sector_t sec_no, const void *buffer)
   if (!wait_while_busy (d))
     PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name, sec_no);
   output_sector (c, buffer);
-  sema_down (&c->completion_wait);
+  wait_for_completion (d);
+
+  /* The write is done once BSY clears, and the disk has taken
+     all of the data only if DRQ is clear by then too. */
+  if (wait_while_busy (d) || (inb (reg_alt_status (c)) & STA_BSY))
+    PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name, sec_no);
   lock_release (&c->lock);
 }
 
@@ -432,6 +438,29 @@ output_sector (struct channel *c, const void *sector)
 
 /* Low-level ATA primitives. */
 
+/* Waits for the interrupt that signals completion of the
+   command just issued to disk D.  If the interrupt does not
+   arrive within a second, gives up on it, so that a lost
+   interrupt cannot hang the caller; the caller's subsequent
+   wait_while_busy() then polls the status register instead. */
+static void
+wait_for_completion (const struct ata_disk *d) 
+{
+  struct channel *c = d->channel;
+
+  if (!sema_down_timeout (&c->completion_wait, TIMER_FREQ))
+    {
+      /* Stop expecting the interrupt, so that if it turns up
+         late it cannot complete a later command prematurely. */
+      enum intr_level old_level = intr_disable ();
+      c->expecting_interrupt = false;
+      sema_try_down (&c->completion_wait);
+      intr_set_level (old_level);
+
+      printf ("%s: no completion interrupt, polling\n", d->name);
+    }
+}
+
 /* Wait up to 10 seconds for the controller to become idle, that
    is, for the BSY and DRQ bits to clear in the status register.
 
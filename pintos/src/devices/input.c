@@ -2,15 +2,21 @@
 #include <debug.h>
 #include "devices/intq.h"
 #include "devices/serial.h"
+#include "threads/synch.h"
 
 /* Stores keys from the keyboard and serial port. */
 static struct intq buffer;
 
+/* Serializes readers, since BUFFER allows only one consumer at
+   a time besides its interrupt handlers. */
+static struct lock read_lock;
+
 /* Initializes the input buffer. */
 void
 input_init (void) 
 {
   intq_init (&buffer);
+  lock_init (&read_lock);
 }
 
 /* Adds a key to the input buffer.
@@ -30,15 +36,33 @@ input_putc (uint8_t key)
 uint8_t
 input_getc (void) 
 {
-  enum intr_level old_level;
   uint8_t key;
 
+  input_read (&key, 1);
+  return key;
+}
+
+/* Retrieves up to MAX keys from the input buffer into BUF and
+   returns the number retrieved.
+   If the buffer is empty, waits for a key to be pressed.
+   Concurrent readers take turns, each getting different keys. */
+size_t
+input_read (uint8_t *buf, size_t max) 
+{
+  enum intr_level old_level;
+  size_t cnt;
+
+  lock_acquire (&read_lock);
+  cnt = intq_get (&buffer, buf, max);
+  lock_release (&read_lock);
+
+  /* The serial port stops receiving while the buffer is full,
+     so let it know there is room again. */
   old_level = intr_disable ();
-  key = intq_getc (&buffer);
   serial_notify ();
   intr_set_level (old_level);
   
-  return key;
+  return cnt;
 }
 
 /* Returns true if the input buffer is full,
@@ -2,9 +2,8 @@
 #include <debug.h>
 #include "threads/thread.h"
 
-static int next (int pos);
-static void wait (struct intq *q, struct thread **waiter);
-static void signal (struct intq *q, struct thread **waiter);
+static void wait (struct intq *q, struct thread *volatile *waiter);
+static void signal (struct intq *q, struct thread *volatile *waiter);
 
 /* Initializes interrupt queue Q. */
 void
@@ -12,23 +11,21 @@ intq_init (struct intq *q)
 {
   lock_init (&q->lock);
   q->not_full = q->not_empty = NULL;
-  q->head = q->tail = 0;
+  ring_init (&q->ring, q->buf, INTQ_BUFSIZE, 1);
 }
 
 /* Returns true if Q is empty, false otherwise. */
 bool
 intq_empty (const struct intq *q) 
 {
-  ASSERT (intr_get_level () == INTR_OFF);
-  return q->head == q->tail;
+  return ring_empty (&q->ring);
 }
 
 /* Returns true if Q is full, false otherwise. */
 bool
 intq_full (const struct intq *q) 
 {
-  ASSERT (intr_get_level () == INTR_OFF);
-  return next (q->head) == q->tail;
+  return ring_full (&q->ring);
 }
 
 /* Removes a byte from Q and returns it.
@@ -38,19 +35,8 @@ uint8_t
 intq_getc (struct intq *q) 
 {
   uint8_t byte;
-  
-  ASSERT (intr_get_level () == INTR_OFF);
-  while (intq_empty (q)) 
-    {
-      ASSERT (!intr_context ());
-      lock_acquire (&q->lock);
-      wait (q, &q->not_empty);
-      lock_release (&q->lock);
-    }
-  
-  byte = q->buf[q->tail];
-  q->tail = next (q->tail);
-  signal (q, &q->not_full);
+
+  intq_get (q, &byte, 1);
   return byte;
 }
 
@@ -60,55 +46,114 @@ intq_getc (struct intq *q)
 void
 intq_putc (struct intq *q, uint8_t byte) 
 {
-  ASSERT (intr_get_level () == INTR_OFF);
-  while (intq_full (q))
+  intq_put (q, &byte, 1);
+}
+
+/* Removes up to MAX bytes from Q into BUF and returns the number
+   removed.  If Q is empty, sleeps until a byte is added.
+   When called from an interrupt handler, Q must not be empty. */
+size_t
+intq_get (struct intq *q, uint8_t *buf, size_t max) 
+{
+  size_t cnt;
+
+  if (max == 0)
+    return 0;
+  while ((cnt = intq_try_get (q, buf, max)) == 0)
+    {
+      lock_acquire (&q->lock);
+      wait (q, &q->not_empty);
+      lock_release (&q->lock);
+    }
+  return cnt;
+}
+
+/* Adds the CNT bytes in BUF to the end of Q, sleeping whenever Q
+   is full until bytes are removed.
+   When called from an interrupt handler, Q must have room for
+   all CNT bytes. */
+void
+intq_put (struct intq *q, const uint8_t *buf, size_t cnt) 
+{
+  for (;;)
     {
-      ASSERT (!intr_context ());
+      size_t n = intq_try_put (q, buf, cnt);
+      buf += n;
+      cnt -= n;
+      if (cnt == 0)
+        break;
+
       lock_acquire (&q->lock);
       wait (q, &q->not_full);
       lock_release (&q->lock);
     }
+}
 
-  q->buf[q->head] = byte;
-  q->head = next (q->head);
-  signal (q, &q->not_empty);
+/* Removes up to MAX bytes from Q into BUF, without sleeping, and
+   returns the number removed. */
+size_t
+intq_try_get (struct intq *q, uint8_t *buf, size_t max) 
+{
+  size_t cnt = ring_get (&q->ring, buf, max);
+  if (cnt > 0)
+    signal (q, &q->not_full);
+  return cnt;
 }
-
-/* Returns the position after POS within an intq. */
-static int
-next (int pos) 
+
+/* Adds up to CNT bytes from BUF to the end of Q, as many as fit,
+   without sleeping, and returns the number added. */
+size_t
+intq_try_put (struct intq *q, const uint8_t *buf, size_t cnt) 
 {
-  return (pos + 1) % INTQ_BUFSIZE;
+  cnt = ring_put (&q->ring, buf, cnt);
+  if (cnt > 0)
+    signal (q, &q->not_empty);
+  return cnt;
 }
 
 /* WAITER must be the address of Q's not_empty or not_full
-   member.  Waits until the given condition is true. */
+   member.  Waits until the given condition is true, if it is
+   not already.
+
+   The condition is checked again with interrupts off, so that a
+   producer or consumer cannot change it between the check and
+   the wait: an interrupt handler cannot run, and on a single
+   CPU neither can another thread. */
 static void
-wait (struct intq *q UNUSED, struct thread **waiter) 
+wait (struct intq *q, struct thread *volatile *waiter) 
 {
+  enum intr_level old_level;
+
   ASSERT (!intr_context ());
-  ASSERT (intr_get_level () == INTR_OFF);
-  ASSERT ((waiter == &q->not_empty && intq_empty (q))
-          || (waiter == &q->not_full && intq_full (q)));
+  ASSERT (waiter == &q->not_empty || waiter == &q->not_full);
 
-  *waiter = thread_current ();
-  thread_block ();
+  old_level = intr_disable ();
+  if (waiter == &q->not_empty ? intq_empty (q) : intq_full (q))
+    {
+      *waiter = thread_current ();
+      thread_block ();
+    }
+  intr_set_level (old_level);
 }
 
 /* WAITER must be the address of Q's not_empty or not_full
-   member, and the associated condition must be true.  If a
-   thread is waiting for the condition, wakes it up and resets
-   the waiting thread. */
+   member, and the associated condition must have become true.
+   If a thread is waiting for the condition, wakes it up and
+   resets the waiting thread.  Only turns interrupts off if there
+   is a thread to wake. */
 static void
-signal (struct intq *q UNUSED, struct thread **waiter) 
+signal (struct intq *q UNUSED, struct thread *volatile *waiter) 
 {
-  ASSERT (intr_get_level () == INTR_OFF);
-  ASSERT ((waiter == &q->not_empty && !intq_empty (q))
-          || (waiter == &q->not_full && !intq_full (q)));
+  ASSERT (waiter == &q->not_empty || waiter == &q->not_full);
 
   if (*waiter != NULL) 
     {
-      thread_unblock (*waiter);
-      *waiter = NULL;
+      enum intr_level old_level = intr_disable ();
+      if (*waiter != NULL)
+        {
+          thread_unblock (*waiter);
+          *waiter = NULL;
+        }
+      intr_set_level (old_level);
     }
 }
@@ -1,43 +1,55 @@
 #ifndef DEVICES_INTQ_H
 #define DEVICES_INTQ_H
 
+#include <ring.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "threads/interrupt.h"
 #include "threads/synch.h"
 
-/* An "interrupt queue", a circular buffer shared between
-   kernel threads and external interrupt handlers.
+/* An "interrupt queue", a circular buffer of bytes shared
+   between kernel threads and external interrupt handlers.
 
-   Interrupt queue functions can be called from kernel threads or
-   from external interrupt handlers.  Except for intq_init(),
-   interrupts must be off in either case.
+   The bytes are kept in a struct ring, so one producer and one
+   consumer can use an interrupt queue at once without turning
+   interrupts off, whether each is a kernel thread or an
+   interrupt handler.  Producers must be serialized among
+   themselves, for example by all running with interrupts off or
+   all in interrupt handlers, and so must consumers.
 
-   The interrupt queue has the structure of a "monitor".  Locks
-   and condition variables from threads/synch.h cannot be used in
-   this case, as they normally would, because they can only
-   protect kernel threads from one another, not from interrupt
-   handlers. */
+   The blocking functions below wait for data or space.  Only a
+   kernel thread may wait, and at most one thread waits for each
+   condition at a time.  Waiting is done with interrupts off,
+   not with locks and condition variables from threads/synch.h,
+   because those can only protect kernel threads from one
+   another, not from interrupt handlers.  The _try functions
+   never wait and may be called from interrupt handlers. */
 
-/* Queue buffer size, in bytes. */
-#define INTQ_BUFSIZE 64
+/* Queue buffer size, in bytes.  Must be a power of two. */
+#define INTQ_BUFSIZE 256
 
 /* A circular queue of bytes. */
 struct intq
   {
     /* Waiting threads. */
     struct lock lock;           /* Only one thread may wait at once. */
-    struct thread *not_full;    /* Thread waiting for not-full condition. */
-    struct thread *not_empty;   /* Thread waiting for not-empty condition. */
+    struct thread *volatile not_full;  /* Thread waiting for space. */
+    struct thread *volatile not_empty; /* Thread waiting for data. */
 
     /* Queue. */
+    struct ring ring;           /* Queue of bytes in BUF. */
     uint8_t buf[INTQ_BUFSIZE];  /* Buffer. */
-    int head;                   /* New data is written here. */
-    int tail;                   /* Old data is read here. */
   };
 
 void intq_init (struct intq *);
 bool intq_empty (const struct intq *);
 bool intq_full (const struct intq *);
+
 uint8_t intq_getc (struct intq *);
 void intq_putc (struct intq *, uint8_t);
+size_t intq_get (struct intq *, uint8_t *, size_t max);
+void intq_put (struct intq *, const uint8_t *, size_t cnt);
+size_t intq_try_get (struct intq *, uint8_t *, size_t max);
+size_t intq_try_put (struct intq *, const uint8_t *, size_t cnt);
 
 #endif /* devices/intq.h */
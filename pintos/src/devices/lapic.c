@@ -0,0 +1,145 @@
+#include "devices/lapic.h"
+#include <debug.h>
+#include <stdint.h>
+#include "devices/timer.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/pte.h"
+#include "threads/vaddr.h"
+
+/* Interface to the local Advanced Programmable Interrupt
+   Controller (APIC) of the running CPU.  Refer to [IA32-v3a]
+   chapter 10 "Advanced Programmable Interrupt Controller" for
+   details.
+
+   Every CPU has its own local APIC at the same physical address,
+   so the single mapping set up by lapic_init() serves them all.
+   The kernel still takes its device interrupts through the 8259A
+   PICs (see interrupt.c); the local APIC is used only to identify
+   the running CPU and to send the interprocessor interrupts that
+   start the other CPUs. */
+
+/* Kernel virtual address at which the registers are mapped.
+   This is the last page of the address space, which lies above
+   any RAM that Pintos maps at PHYS_BASE. */
+#define LAPIC_VADDR ((void *) 0xfffff000)
+
+/* Register offsets, in bytes. */
+#define LAPIC_ID      0x020     /* Local APIC ID. */
+#define LAPIC_SVR     0x0f0     /* Spurious interrupt vector. */
+#define LAPIC_ICR_LO  0x300     /* Interrupt command, low word. */
+#define LAPIC_ICR_HI  0x310     /* Interrupt command, high word. */
+
+/* LAPIC_SVR bits. */
+#define SVR_ENABLE    0x100     /* APIC software enable. */
+#define SVR_VECTOR    0xff      /* Spurious interrupt vector. */
+
+/* LAPIC_ICR_LO bits. */
+#define ICR_INIT      0x00000500        /* INIT delivery mode. */
+#define ICR_STARTUP   0x00000600        /* Start-up delivery mode. */
+#define ICR_PENDING   0x00001000        /* Delivery status: send pending. */
+#define ICR_ASSERT    0x00004000        /* Level: assert. */
+
+/* Mapped registers, or a null pointer if there is no local
+   APIC. */
+static volatile uint32_t *lapic;
+
+static bool send_ipi (uint8_t apic_id, uint32_t command);
+static intr_handler_func spurious_interrupt;
+
+/* Maps the local APIC registers, which are at physical address
+   PADDR, into the kernel page directory.  Must be called before
+   the first user process is created, because page directories
+   inherit their kernel mappings from init_page_dir. */
+void
+lapic_init (uintptr_t paddr) 
+{
+  uint32_t *pt;
+  size_t pde_idx = pd_no (LAPIC_VADDR);
+
+  ASSERT (pg_ofs ((void *) paddr) == 0);
+  ASSERT (init_page_dir[pde_idx] == 0);
+
+  pt = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+  pt[pt_no (LAPIC_VADDR)] = paddr | PTE_PCD | PTE_PWT | PTE_W | PTE_P;
+  init_page_dir[pde_idx] = pde_create (pt);
+  lapic = LAPIC_VADDR;
+
+  intr_register_int (SVR_VECTOR, 0, INTR_OFF, spurious_interrupt,
+                     "LAPIC Spurious Interrupt");
+}
+
+/* Returns true if lapic_init() has mapped the local APIC. */
+bool
+lapic_present (void) 
+{
+  return lapic != NULL;
+}
+
+/* Enables the running CPU's local APIC.  Spurious interrupts are
+   delivered to vector 0xff and ignored. */
+void
+lapic_enable (void) 
+{
+  ASSERT (lapic_present ());
+  lapic[LAPIC_SVR / 4] = SVR_ENABLE | SVR_VECTOR;
+}
+
+/* Returns the local APIC ID of the running CPU. */
+uint8_t
+lapic_id (void) 
+{
+  ASSERT (lapic_present ());
+  return lapic[LAPIC_ID / 4] >> 24;
+}
+
+/* Sends an INIT interprocessor interrupt to the CPU with the
+   given APIC_ID, which resets it into the wait-for-SIPI state.
+   Returns true if successful, false if the interrupt was not
+   accepted for delivery. */
+bool
+lapic_send_init (uint8_t apic_id) 
+{
+  return send_ipi (apic_id, ICR_INIT | ICR_ASSERT);
+}
+
+/* Sends a start-up interprocessor interrupt to the CPU with the
+   given APIC_ID, which begins executing in real mode at physical
+   address PADDR.  PADDR must be page-aligned and below 1 MB.
+   Returns true if successful, false if the interrupt was not
+   accepted for delivery. */
+bool
+lapic_send_startup (uint8_t apic_id, uintptr_t paddr) 
+{
+  ASSERT (pg_ofs ((void *) paddr) == 0 && paddr < 0x100000);
+  return send_ipi (apic_id, ICR_STARTUP | ICR_ASSERT | (paddr >> PGBITS));
+}
+
+/* Writes COMMAND to the interrupt command register, directed at
+   APIC_ID, and waits up to about a millisecond for the local
+   APIC to accept it. */
+static bool
+send_ipi (uint8_t apic_id, uint32_t command) 
+{
+  int i;
+
+  ASSERT (lapic_present ());
+
+  lapic[LAPIC_ICR_HI / 4] = (uint32_t) apic_id << 24;
+  lapic[LAPIC_ICR_LO / 4] = command;
+  for (i = 0; i < 100; i++)
+    {
+      if (!(lapic[LAPIC_ICR_LO / 4] & ICR_PENDING))
+        return true;
+      timer_udelay (10);
+    }
+  return false;
+}
+
+/* Spurious interrupt handler.  The local APIC does not expect an
+   end-of-interrupt for these, so there is nothing to do. */
+static void
+spurious_interrupt (struct intr_frame *f UNUSED) 
+{
+}
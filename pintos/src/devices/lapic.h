@@ -0,0 +1,17 @@
+#ifndef DEVICES_LAPIC_H
+#define DEVICES_LAPIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Physical address of the local APIC registers after reset. */
+#define LAPIC_DEFAULT_BASE 0xfee00000
+
+void lapic_init (uintptr_t paddr);
+bool lapic_present (void);
+void lapic_enable (void);
+uint8_t lapic_id (void);
+bool lapic_send_init (uint8_t apic_id);
+bool lapic_send_startup (uint8_t apic_id, uintptr_t paddr);
+
+#endif /* devices/lapic.h */
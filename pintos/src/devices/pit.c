@@ -11,9 +11,6 @@
 #define PIT_PORT_CONTROL          0x43                /* Control port. */
 #define PIT_PORT_COUNTER(CHANNEL) (0x40 + (CHANNEL))  /* Counter port. */
 
-/* PIT cycles per second. */
-#define PIT_HZ 1193180
-
 /* Configure the given CHANNEL in the PIT.  In a PC, the PIT's
    three output channels are hooked up like this:
 
@@ -81,3 +78,53 @@ pit_configure_channel (int channel, int mode, int frequency)
   outb (PIT_PORT_COUNTER (channel), count >> 8);
   intr_set_level (old_level);
 }
+
+/* Configures CHANNEL in the PIT to count down CYCLES PIT cycles
+   once, then raise its output and keep it raised ("interrupt on
+   terminal count", mode 0).  On channel 0, the rising output
+   triggers a single timer interrupt.  CYCLES must be between 1
+   and 65536.  Reconfigure the channel with
+   pit_configure_channel() to return to periodic operation. */
+void
+pit_configure_oneshot (int channel, unsigned cycles)
+{
+  enum intr_level old_level;
+
+  ASSERT (channel == 0);
+  ASSERT (cycles >= 1 && cycles <= 65536);
+
+  /* A count of 0 stands for 65536. */
+  old_level = intr_disable ();
+  outb (PIT_PORT_CONTROL, (channel << 6) | 0x30 | (0 << 1));
+  outb (PIT_PORT_COUNTER (channel), cycles);
+  outb (PIT_PORT_COUNTER (channel), cycles >> 8);
+  intr_set_level (old_level);
+}
+
+/* Returns the current count of CHANNEL in the PIT, that is, the
+   number of PIT cycles left until the end of its current period
+   or, in one-shot mode, until it fires.  If OUTPUT is nonnull,
+   stores the state of the channel's output in *OUTPUT: in
+   one-shot mode, it is true once the count has run out.
+
+   Uses the 8254 read-back command to latch the count and status
+   atomically. */
+unsigned
+pit_read_channel (int channel, bool *output)
+{
+  enum intr_level old_level;
+  uint8_t status, lo, hi;
+
+  ASSERT (channel == 0 || channel == 2);
+
+  old_level = intr_disable ();
+  outb (PIT_PORT_CONTROL, 0xc0 | (1 << (channel + 1)));
+  status = inb (PIT_PORT_COUNTER (channel));
+  lo = inb (PIT_PORT_COUNTER (channel));
+  hi = inb (PIT_PORT_COUNTER (channel));
+  intr_set_level (old_level);
+
+  if (output != NULL)
+    *output = (status & 0x80) != 0;
+  return lo | (hi << 8);
+}
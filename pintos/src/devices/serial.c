@@ -5,6 +5,7 @@
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
+#include "threads/softirq.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
 
@@ -37,6 +38,17 @@
 #define IER_RECV 0x01           /* Interrupt when data received. */
 #define IER_XMIT 0x02           /* Interrupt when transmit finishes. */
 
+/* Interrupt Identification Register bits. */
+#define IIR_FIFO 0xc0           /* FIFOs enabled. */
+
+/* FIFO Control Register bits. */
+#define FCR_ENABLE 0x01         /* Enable FIFOs. */
+#define FCR_CLEAR_RECV 0x02     /* Clear receive FIFO. */
+#define FCR_CLEAR_XMIT 0x04     /* Clear transmit FIFO. */
+
+/* Size of the 16550A transmit FIFO, in bytes. */
+#define XMIT_FIFO_SIZE 16
+
 /* Line Control Register bits. */
 #define LCR_N81 0x03            /* No parity, 8 data bits, 1 stop bit. */
 #define LCR_DLAB 0x80           /* Divisor Latch Access Bit (DLAB). */
@@ -54,10 +66,16 @@ static enum { UNINIT, POLL, QUEUE } mode;
 /* Data to be transmitted. */
 static struct intq txq;
 
+/* Number of bytes the UART accepts each time the transmitter
+   holding register empties: XMIT_FIFO_SIZE once the FIFOs are
+   enabled, 1 on an 8250 or 16450 that has no FIFOs. */
+static size_t xmit_burst = 1;
+
 static void set_serial (int bps);
 static void putc_poll (uint8_t);
 static void write_ier (void);
 static intr_handler_func serial_interrupt;
+static softirq_func serial_softirq;
 
 /* Initializes the serial port device for polling mode.
    Polling mode busy-waits for the serial port to become free
@@ -87,6 +105,15 @@ serial_init_queue (void)
     init_poll ();
   ASSERT (mode == POLL);
 
+  /* Enable the FIFOs, if the UART has them, so that each
+     transmit interrupt can move a burst of bytes. */
+  outb (FCR_REG, FCR_ENABLE | FCR_CLEAR_RECV | FCR_CLEAR_XMIT);
+  if ((inb (IIR_REG) & IIR_FIFO) == IIR_FIFO)
+    xmit_burst = XMIT_FIFO_SIZE;
+  else
+    outb (FCR_REG, 0);
+
+  softirq_register (SOFTIRQ_SERIAL, serial_softirq, "serial");
   intr_register_ext (0x20 + 4, serial_interrupt, "serial");
   mode = QUEUE;
   old_level = intr_disable ();
@@ -97,34 +124,56 @@ serial_init_queue (void)
 /* Sends BYTE to the serial port. */
 void
 serial_putc (uint8_t byte) 
+{
+  serial_write (&byte, 1);
+}
+
+/* Sends the N bytes in BUF to the serial port. */
+void
+serial_write (const uint8_t *buf, size_t n) 
 {
   enum intr_level old_level = intr_disable ();
 
   if (mode != QUEUE)
     {
       /* If we're not set up for interrupt-driven I/O yet,
-         use dumb polling to transmit a byte. */
+         use dumb polling to transmit the bytes. */
       if (mode == UNINIT)
         init_poll ();
-      putc_poll (byte); 
+      while (n-- > 0)
+        putc_poll (*buf++); 
     }
   else 
-    {
-      /* Otherwise, queue a byte and update the interrupt enable
-         register. */
-      if (old_level == INTR_OFF && intq_full (&txq)) 
-        {
-          /* Interrupts are off and the transmit queue is full.
-             If we wanted to wait for the queue to empty,
-             we'd have to reenable interrupts.
-             That's impolite, so we'll send a character via
-             polling instead. */
-          putc_poll (intq_getc (&txq)); 
-        }
-
-      intq_putc (&txq, byte); 
-      write_ier ();
-    }
+    while (n > 0)
+      {
+        /* Otherwise, queue as many bytes as fit and update the
+           interrupt enable register. */
+        size_t cnt = intq_try_put (&txq, buf, n);
+        buf += cnt;
+        n -= cnt;
+        write_ier ();
+        if (n == 0)
+          break;
+
+        if (old_level == INTR_OFF) 
+          {
+            /* Interrupts are off and the transmit queue is full.
+               If we wanted to wait for the queue to empty,
+               we'd have to reenable interrupts.
+               That's impolite, so we'll send a character via
+               polling instead. */
+            uint8_t byte;
+            intq_try_get (&txq, &byte, 1);
+            putc_poll (byte);
+          }
+        else
+          {
+            /* Wait for room for one more byte.  The transmit
+               interrupt is enabled, since the queue is full. */
+            intq_putc (&txq, *buf++);
+            n--;
+          }
+      }
   
   intr_set_level (old_level);
 }
@@ -135,8 +184,10 @@ void
 serial_flush (void) 
 {
   enum intr_level old_level = intr_disable ();
-  while (!intq_empty (&txq))
-    putc_poll (intq_getc (&txq));
+  uint8_t byte;
+
+  while (intq_try_get (&txq, &byte, 1) > 0)
+    putc_poll (byte);
   intr_set_level (old_level);
 }
 
@@ -205,7 +256,9 @@ putc_poll (uint8_t byte)
   outb (THR_REG, byte);
 }
 
-/* Serial interrupt handler. */
+/* Serial interrupt handler.  Masks the UART's interrupts and
+   leaves moving the data to serial_softirq(), so that heavy
+   serial traffic does not keep interrupts off for long. */
 static void
 serial_interrupt (struct intr_frame *f UNUSED) 
 {
@@ -213,16 +266,50 @@ serial_interrupt (struct intr_frame *f UNUSED)
      occasionally miss an interrupt running under QEMU. */
   inb (IIR_REG);
 
+  outb (IER_REG, 0);
+  softirq_raise (SOFTIRQ_SERIAL);
+}
+
+/* Serial softirq.  Interrupts are turned off only while
+   receiving each byte and while refilling the transmit FIFO, so
+   that the timer can interrupt in between. */
+static void
+serial_softirq (void) 
+{
+  enum intr_level old_level;
+
   /* As long as we have room to receive a byte, and the hardware
      has a byte for us, receive a byte.  */
-  while (!input_full () && (inb (LSR_REG) & LSR_DR) != 0)
-    input_putc (inb (RBR_REG));
+  for (;;) 
+    {
+      bool received = false;
+
+      old_level = intr_disable ();
+      if (!input_full () && (inb (LSR_REG) & LSR_DR) != 0)
+        {
+          input_putc (inb (RBR_REG));
+          received = true;
+        }
+      intr_set_level (old_level);
+      if (!received)
+        break;
+    }
+
+  old_level = intr_disable ();
 
-  /* As long as we have a byte to transmit, and the hardware is
-     ready to accept a byte for transmission, transmit a byte. */
-  while (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0) 
-    outb (THR_REG, intq_getc (&txq));
+  /* If the hardware is ready to accept bytes for transmission,
+     fill its transmit FIFO from the queue. */
+  if ((inb (LSR_REG) & LSR_THRE) != 0) 
+    {
+      uint8_t burst[XMIT_FIFO_SIZE];
+      size_t cnt = intq_try_get (&txq, burst, xmit_burst);
+      size_t i;
+
+      for (i = 0; i < cnt; i++)
+        outb (THR_REG, burst[i]);
+    }
 
-  /* Update interrupt enable register based on queue status. */
+  /* Unmask the interrupts that the queues' state calls for. */
   write_ier ();
+  intr_set_level (old_level);
 }
@@ -4,10 +4,16 @@
 #include "devices/kbd.h"
 #include "devices/serial.h"
 #include "devices/timer.h"
+#include "threads/fpu.h"
 #include "threads/io.h"
+#include "threads/latency.h"
+#include "threads/lockstat.h"
+#include "threads/softirq.h"
+#include "threads/task.h"
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
+#include "userprog/sysstat.h"
 #endif
 #ifdef FILESYS
 #include "devices/block.h"
@@ -121,6 +127,12 @@ print_stats (void)
 {
   timer_print_stats ();
   thread_print_stats ();
+  thread_print_schedstats ();
+  latency_print_stats ();
+  lockstat_print_stats ();
+  softirq_print_stats ();
+  task_print_stats ();
+  fpu_print_stats ();
 #ifdef FILESYS
   block_print_stats ();
 #endif
@@ -128,5 +140,6 @@ print_stats (void)
   kbd_print_stats ();
 #ifdef USERPROG
   exception_print_stats ();
+  sysstat_print_stats ();
 #endif
 }
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include "devices/pit.h"
 #include "threads/interrupt.h"
+#include "threads/softirq.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
   
@@ -20,11 +21,62 @@
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
+/* Hierarchical timing wheel holding the pending timer events.
+
+   Level 0 has one slot per tick for the next WHEEL_SIZE ticks.
+   Each slot of level L > 0 covers WHEEL_SIZE**L ticks, and the
+   whole of level L spans WHEEL_SIZE**(L+1) ticks.  An event is
+   filed in the lowest level whose span reaches its deadline, so
+   arming and canceling are O(1).  Whenever the level-0 index
+   wraps around, the events in the next slot of level 1 are
+   "cascaded", that is, refiled, which moves them down to level
+   0; likewise level 2 cascades into level 1 whenever level 1
+   wraps around, and so on.  Each event is cascaded at most once
+   per level.
+
+   Events further in the future than the whole wheel spans are
+   filed in the last slot of the top level and refiled each time
+   that slot is cascaded, until their deadline comes in range. */
+#define WHEEL_BITS 6                    /* Log2 of slots per level. */
+#define WHEEL_SIZE (1 << WHEEL_BITS)    /* Slots per level. */
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4                  /* Number of levels. */
+static struct list wheel[WHEEL_LEVELS][WHEEL_SIZE];
+
+/* Next tick to be processed by the timing wheel.  Events due at
+   or before this tick are in level 0.  The wheel is advanced by
+   the timer softirq, so this may lag behind `ticks'. */
+static int64_t wheel_tick;
+
+/* Tickless idle.
+
+   When the idle thread is about to halt the CPU, it switches the
+   PIT from periodic to one-shot mode, programmed to fire when
+   the next timer event is due, so that the CPU is not woken up
+   TIMER_FREQ times a second for nothing.  Any interrupt switches
+   the PIT back to periodic mode, after catching up on the ticks
+   that went by in the meantime.
+
+   A one-shot count is limited to 16 bits, so this skips at most
+   NOHZ_MAX_TICKS ticks in a row. */
+#define PIT_CYCLES_PER_TICK ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+#define NOHZ_MAX_TICKS (65536 / PIT_CYCLES_PER_TICK)
+static bool nohz_active;        /* Is the PIT in one-shot mode? */
+static int64_t nohz_ticks;      /* Ticks until the one-shot fires. */
+static unsigned nohz_first;     /* PIT cycles until the first of them. */
+static unsigned nohz_cycles;    /* PIT cycles until the one-shot fires. */
+
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
 static intr_handler_func timer_interrupt;
+static softirq_func timer_softirq;
+static void wheel_insert (struct timer_event *);
+static void wheel_advance (void);
+static int64_t wheel_next_event (int64_t limit);
+static void tick (void);
+static void wake_sleeper (void *thread);
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
@@ -35,8 +87,16 @@ static void real_time_delay (int64_t num, int32_t denom);
 void
 timer_init (void) 
 {
+  int level, slot;
+
+  for (level = 0; level < WHEEL_LEVELS; level++)
+    for (slot = 0; slot < WHEEL_SIZE; slot++)
+      list_init (&wheel[level][slot]);
+  wheel_tick = ticks + 1;
+
   pit_configure_channel (0, 2, TIMER_FREQ);
   intr_register_ext (0x20, timer_interrupt, "8254 Timer");
+  softirq_register (SOFTIRQ_TIMER, timer_softirq, "timer");
 }
 
 /* Calibrates loops_per_tick, used to implement brief delays. */
@@ -85,15 +145,72 @@ timer_elapsed (int64_t then)
 }
 
 /* Sleeps for approximately TICKS timer ticks.  Interrupts must
-   be turned on. */
+   be turned on.
+
+   The thread blocks until a timer event wakes it up, so it uses
+   no CPU time while it sleeps. */
 void
 timer_sleep (int64_t ticks) 
 {
-  int64_t start = timer_ticks ();
+  struct timer_event wakeup;
+  enum intr_level old_level;
 
   ASSERT (intr_get_level () == INTR_ON);
-  while (timer_elapsed (start) < ticks) 
-    thread_yield ();
+  if (ticks <= 0)
+    return;
+
+  old_level = intr_disable ();
+  timer_add (&wakeup, timer_ticks () + ticks, wake_sleeper, thread_current ());
+  thread_block ();
+  intr_set_level (old_level);
+}
+
+/* Arms EVENT to call CALLBACK, passing AUX, from the timer
+   softirq at tick DEADLINE.  If DEADLINE has already
+   passed, the event fires at the next tick.  EVENT must not
+   already be pending.
+
+   This function may be called from an interrupt handler. */
+void
+timer_add (struct timer_event *event, int64_t deadline,
+           timer_callback_func *callback, void *aux)
+{
+  enum intr_level old_level;
+
+  ASSERT (event != NULL);
+  ASSERT (callback != NULL);
+
+  old_level = intr_disable ();
+  event->deadline = deadline;
+  event->callback = callback;
+  event->aux = aux;
+  event->pending = true;
+  wheel_insert (event);
+  intr_set_level (old_level);
+}
+
+/* Disarms EVENT.  Returns true if EVENT was pending, false if it
+   had already fired or had never been armed.
+
+   This function may be called from an interrupt handler. */
+bool
+timer_cancel (struct timer_event *event)
+{
+  enum intr_level old_level;
+  bool was_pending;
+
+  ASSERT (event != NULL);
+
+  old_level = intr_disable ();
+  was_pending = event->pending;
+  if (was_pending)
+    {
+      list_remove (&event->elem);
+      event->pending = false;
+    }
+  intr_set_level (old_level);
+
+  return was_pending;
 }
 
 /* Sleeps for approximately MS milliseconds.  Interrupts must be
@@ -166,12 +283,215 @@ timer_print_stats (void)
   printf ("Timer: %"PRId64" ticks\n", timer_ticks ());
 }
 
+/* Switches the PIT to one-shot mode for as many ticks as
+   possible without missing a timer event.  Called by the idle
+   thread, with interrupts off, just before it halts the CPU.
+
+   The one-shot count is chosen so that it runs out exactly when
+   the periodic timer would have produced its Nth interrupt, so
+   that the tick phase is preserved. */
+void
+timer_nohz_enter (void) 
+{
+  int64_t n;
+  unsigned first;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (!nohz_active);
+
+  /* Don't skip the tick at the end of each second, which the
+     multi-level feedback queue scheduler relies on. */
+  n = TIMER_FREQ - ticks % TIMER_FREQ;
+  if (n > NOHZ_MAX_TICKS)
+    n = NOHZ_MAX_TICKS;
+  n = wheel_next_event (ticks + n) - ticks;
+
+  first = pit_read_channel (0, NULL);
+  if (first == 0 || first > PIT_CYCLES_PER_TICK)
+    first = PIT_CYCLES_PER_TICK;
+  while (n > 1 && first + (n - 1) * PIT_CYCLES_PER_TICK > 65536)
+    n--;
+  if (n <= 1)
+    return;
+
+  nohz_active = true;
+  nohz_ticks = n;
+  nohz_first = first;
+  nohz_cycles = first + (n - 1) * PIT_CYCLES_PER_TICK;
+  pit_configure_oneshot (0, nohz_cycles);
+}
+
+/* Leaves tickless mode, if active: accounts for the ticks that
+   elapsed while the PIT was in one-shot mode, as if the timer
+   interrupt had occurred for each of them, then puts the PIT
+   back in periodic mode.  Called at the start of every external
+   interrupt. */
+void
+timer_nohz_exit (void) 
+{
+  int64_t elapsed;
+  unsigned count;
+  bool expired;
+
+  ASSERT (intr_context ());
+
+  if (!nohz_active)
+    return;
+  nohz_active = false;
+
+  count = pit_read_channel (0, &expired);
+  if (expired)
+    {
+      /* The one-shot interrupt is being handled now or is
+         pending, and will account for the last tick itself. */
+      elapsed = nohz_ticks - 1;
+    }
+  else
+    {
+      unsigned cycles = nohz_cycles - count;
+      elapsed = (cycles < nohz_first ? 0
+                 : 1 + (cycles - nohz_first) / PIT_CYCLES_PER_TICK);
+    }
+
+  /* Resuming periodic mode loses the fraction of a tick that
+     has elapsed since the last whole one. */
+  pit_configure_channel (0, 2, TIMER_FREQ);
+  while (elapsed-- > 0)
+    tick ();
+}
+
 /* Timer interrupt handler. */
 static void
 timer_interrupt (struct intr_frame *args UNUSED)
+{
+  tick ();
+}
+
+/* Advances the tick count by one, lets the scheduler account
+   for the tick, and raises the timer softirq to fire the timer
+   events that have come due. */
+static void
+tick (void) 
 {
   ticks++;
   thread_tick ();
+  softirq_raise (SOFTIRQ_TIMER);
+}
+
+/* Timer softirq: brings the timing wheel up to date, firing the
+   events that have come due.  Each tick is processed with
+   interrupts off, but interrupts are let in between ticks. */
+static void
+timer_softirq (void) 
+{
+  for (;;)
+    {
+      enum intr_level old_level = intr_disable ();
+      bool done = wheel_tick > ticks;
+
+      if (!done)
+        wheel_advance ();
+      intr_set_level (old_level);
+      if (done)
+        break;
+    }
+}
+
+/* Files EVENT in the timing wheel slot that covers its
+   deadline. */
+static void
+wheel_insert (struct timer_event *event)
+{
+  int64_t delta = event->deadline - wheel_tick;
+  int64_t when = event->deadline;
+  int level;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (delta < 0)
+    {
+      /* Overdue: fire at the next tick processed. */
+      delta = 0;
+      when = wheel_tick;
+    }
+  else if (delta >= (int64_t) 1 << (WHEEL_BITS * WHEEL_LEVELS))
+    {
+      /* Beyond the wheel's span: park in the farthest slot. */
+      delta = ((int64_t) 1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+      when = wheel_tick + delta;
+    }
+
+  for (level = 0; delta >= (int64_t) 1 << (WHEEL_BITS * (level + 1)); level++)
+    continue;
+  list_push_back (&wheel[level][(when >> (WHEEL_BITS * level)) & WHEEL_MASK],
+                  &event->elem);
+}
+
+/* Processes tick wheel_tick: cascades higher levels as needed,
+   then fires every event in the current level-0 slot. */
+static void
+wheel_advance (void)
+{
+  struct list *slot;
+  struct list expired;
+  int level;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  /* Cascade.  Level L+1 is cascaded whenever the indexes of all
+     the levels up to L have wrapped around to 0. */
+  for (level = 1; level < WHEEL_LEVELS; level++)
+    {
+      int64_t index = wheel_tick >> (WHEEL_BITS * (level - 1));
+      struct list *upper;
+
+      if ((index & WHEEL_MASK) != 0)
+        break;
+      upper = &wheel[level][(index >> WHEEL_BITS) & WHEEL_MASK];
+      while (!list_empty (upper))
+        wheel_insert (list_entry (list_pop_front (upper),
+                                  struct timer_event, elem));
+    }
+
+  /* Take the expired events off the wheel before calling any
+     callback, so that a callback that arms an overdue event
+     cannot make this loop run forever. */
+  slot = &wheel[0][wheel_tick & WHEEL_MASK];
+  list_init (&expired);
+  if (!list_empty (slot))
+    list_splice (list_end (&expired), list_begin (slot), list_end (slot));
+  wheel_tick++;
+
+  while (!list_empty (&expired))
+    {
+      struct timer_event *event = list_entry (list_pop_front (&expired),
+                                              struct timer_event, elem);
+      event->pending = false;
+      event->callback (event->aux);
+    }
+}
+
+/* Returns the first tick no later than LIMIT at which the timing
+   wheel may have an event to fire.  Conservatively treats the
+   ticks at which a higher level cascades as events. */
+static int64_t
+wheel_next_event (int64_t limit)
+{
+  int64_t t;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (t = wheel_tick; t < limit; t++)
+    if ((t & WHEEL_MASK) == 0 || !list_empty (&wheel[0][t & WHEEL_MASK]))
+      return t;
+  return limit;
+}
+
+/* Timer callback for timer_sleep(): wakes up THREAD. */
+static void
+wake_sleeper (void *thread)
+{
+  thread_unblock (thread);
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
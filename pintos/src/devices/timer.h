@@ -1,12 +1,30 @@
 #ifndef DEVICES_TIMER_H
 #define DEVICES_TIMER_H
 
+#include <list.h>
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
+/* Function called when a timer event expires.  Runs in the
+   timer softirq with interrupts off, so it must not sleep. */
+typedef void timer_callback_func (void *aux);
+
+/* A timer event, armed with timer_add().  The caller owns the
+   storage, which must stay valid until the event fires or is
+   canceled. */
+struct timer_event
+  {
+    struct list_elem elem;              /* Element in a timer wheel slot. */
+    int64_t deadline;                   /* Tick at which to fire. */
+    timer_callback_func *callback;      /* Function to call. */
+    void *aux;                          /* Auxiliary data for callback. */
+    bool pending;                       /* Armed and not yet fired? */
+  };
+
 void timer_init (void);
 void timer_calibrate (void);
 
@@ -19,6 +37,15 @@ void timer_msleep (int64_t milliseconds);
 void timer_usleep (int64_t microseconds);
 void timer_nsleep (int64_t nanoseconds);
 
+/* Timer events. */
+void timer_add (struct timer_event *, int64_t deadline,
+                timer_callback_func *, void *aux);
+bool timer_cancel (struct timer_event *);
+
+/* Tickless idle. */
+void timer_nohz_enter (void);
+void timer_nohz_exit (void);
+
 /* Busy waits. */
 void timer_mdelay (int64_t milliseconds);
 void timer_udelay (int64_t microseconds);
@@ -5,7 +5,10 @@
 #include <string.h>
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
+#include "threads/interrupt.h"
 #include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -36,6 +39,7 @@ struct inode
     int open_cnt;                       /* Number of openers. */
     bool removed;                       /* True if deleted, false otherwise. */
     int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
+    struct rwlock rwlock;               /* Guards directory contents. */
     struct inode_disk data;             /* Inode content. */
   };
 
@@ -57,11 +61,18 @@ byte_to_sector (const struct inode *inode, off_t pos)
    returns the same `struct inode'. */
 static struct list open_inodes;
 
+/* Guards open_inodes.  Opening an inode that is already open,
+   by far the common case, only reads the list, so it takes
+   this for reading; adding and removing inodes take it for
+   writing. */
+static struct rwlock open_inodes_lock;
+
 /* Initializes the inode module. */
 void
 inode_init (void) 
 {
   list_init (&open_inodes);
+  rwlock_init (&open_inodes_lock);
 }
 
 /* Initializes an inode with LENGTH bytes of data and
@@ -96,7 +107,10 @@ inode_create (block_sector_t sector, off_t length)
               size_t i;
               
               for (i = 0; i < sectors; i++) 
-                block_write (fs_device, disk_inode->start + i, zeros);
+                {
+                  block_write (fs_device, disk_inode->start + i, zeros);
+                  cond_resched ();
+                }
             }
           success = true; 
         } 
@@ -105,48 +119,80 @@ inode_create (block_sector_t sector, off_t length)
   return success;
 }
 
-/* Reads an inode from SECTOR
-   and returns a `struct inode' that contains it.
-   Returns a null pointer if memory allocation fails. */
-struct inode *
-inode_open (block_sector_t sector)
+/* Returns the open inode for SECTOR, reopening it, or a null
+   pointer if SECTOR is not open.  open_inodes_lock must be held
+   for reading or writing. */
+static struct inode *
+reopen_open_inode (block_sector_t sector)
 {
   struct list_elem *e;
-  struct inode *inode;
 
-  /* Check whether this inode is already open. */
   for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
        e = list_next (e)) 
     {
-      inode = list_entry (e, struct inode, elem);
+      struct inode *inode = list_entry (e, struct inode, elem);
       if (inode->sector == sector) 
-        {
-          inode_reopen (inode);
-          return inode; 
-        }
+        return inode_reopen (inode);
     }
+  return NULL;
+}
+
+/* Reads an inode from SECTOR
+   and returns a `struct inode' that contains it.
+   Returns a null pointer if memory allocation fails. */
+struct inode *
+inode_open (block_sector_t sector)
+{
+  struct inode *inode, *open;
+
+  /* Check whether this inode is already open. */
+  rwlock_acquire_read (&open_inodes_lock);
+  inode = reopen_open_inode (sector);
+  rwlock_release_read (&open_inodes_lock);
+  if (inode != NULL)
+    return inode;
 
   /* Allocate memory. */
   inode = malloc (sizeof *inode);
   if (inode == NULL)
     return NULL;
 
-  /* Initialize. */
-  list_push_front (&open_inodes, &inode->elem);
+  /* Initialize, reading the disk inode without holding the lock
+     so that other openers are not stuck behind the disk. */
   inode->sector = sector;
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
   inode->removed = false;
+  rwlock_init (&inode->rwlock);
   block_read (fs_device, inode->sector, &inode->data);
+
+  /* Someone else may have opened the same inode while we were
+     reading it.  If so, use theirs. */
+  rwlock_acquire_write (&open_inodes_lock);
+  open = reopen_open_inode (sector);
+  if (open == NULL)
+    list_push_front (&open_inodes, &inode->elem);
+  rwlock_release_write (&open_inodes_lock);
+  if (open != NULL)
+    {
+      free (inode);
+      inode = open;
+    }
   return inode;
 }
 
-/* Reopens and returns INODE. */
+/* Reopens and returns INODE.
+   Several readers of open_inodes may reopen the same inode at
+   once, so the count is updated with interrupts off. */
 struct inode *
 inode_reopen (struct inode *inode)
 {
   if (inode != NULL)
-    inode->open_cnt++;
+    {
+      enum intr_level old_level = intr_disable ();
+      inode->open_cnt++;
+      intr_set_level (old_level);
+    }
   return inode;
 }
 
@@ -157,6 +203,24 @@ inode_get_inumber (const struct inode *inode)
   return inode->sector;
 }
 
+/* Drops a reference to INODE.  If it was the last one, removes
+   INODE from open_inodes and returns true. */
+static bool
+inode_release (struct inode *inode)
+{
+  enum intr_level old_level;
+  bool last;
+
+  rwlock_acquire_write (&open_inodes_lock);
+  old_level = intr_disable ();
+  last = --inode->open_cnt == 0;
+  intr_set_level (old_level);
+  if (last)
+    list_remove (&inode->elem);
+  rwlock_release_write (&open_inodes_lock);
+  return last;
+}
+
 /* Closes INODE and writes it to disk.
    If this was the last reference to INODE, frees its memory.
    If INODE was also a removed inode, frees its blocks. */
@@ -168,11 +232,8 @@ inode_close (struct inode *inode)
     return;
 
   /* Release resources if this was the last opener. */
-  if (--inode->open_cnt == 0)
+  if (inode_release (inode))
     {
-      /* Remove from inode list and release lock. */
-      list_remove (&inode->elem);
- 
       /* Deallocate blocks if removed. */
       if (inode->removed) 
         {
@@ -243,6 +304,7 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
       size -= chunk_size;
       offset += chunk_size;
       bytes_read += chunk_size;
+      cond_resched ();
     }
   free (bounce);
 
@@ -311,6 +373,7 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
       size -= chunk_size;
       offset += chunk_size;
       bytes_written += chunk_size;
+      cond_resched ();
     }
   free (bounce);
 
@@ -337,6 +400,14 @@ inode_allow_write (struct inode *inode)
   inode->deny_write_cnt--;
 }
 
+/* Returns the reader-writer lock that guards the contents of
+   INODE when it is a directory. */
+struct rwlock *
+inode_rwlock (struct inode *inode)
+{
+  return &inode->rwlock;
+}
+
 /* Returns the length, in bytes, of INODE's data. */
 off_t
 inode_length (const struct inode *inode)
@@ -153,8 +153,10 @@ void
 putbuf (const char *buffer, size_t n) 
 {
   acquire_console ();
+  write_cnt += n;
+  serial_write ((const uint8_t *) buffer, n);
   while (n-- > 0)
-    putchar_have_lock (*buffer++);
+    vga_putc (*buffer++);
   release_console ();
 }
 
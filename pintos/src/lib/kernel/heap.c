@@ -0,0 +1,177 @@
+#include "heap.h"
+#include "../debug.h"
+
+static struct heap_elem *link (struct heap *,
+                               struct heap_elem *, struct heap_elem *);
+static struct heap_elem *link_pairs (struct heap *, struct heap_elem *);
+
+/* Initializes H as an empty heap ordered by LESS given auxiliary
+   data AUX. */
+void
+heap_init (struct heap *h, heap_less_func *less, void *aux) 
+{
+  ASSERT (h != NULL);
+  ASSERT (less != NULL);
+
+  h->root = NULL;
+  h->size = 0;
+  h->less = less;
+  h->aux = aux;
+}
+
+/* Inserts E into H. */
+void
+heap_insert (struct heap *h, struct heap_elem *e) 
+{
+  ASSERT (h != NULL);
+  ASSERT (e != NULL);
+
+  e->child = e->next = e->prev = NULL;
+  h->root = link (h, h->root, e);
+  h->size++;
+}
+
+/* Returns the minimum element in H, without removing it.
+   Returns a null pointer if H is empty. */
+struct heap_elem *
+heap_min (const struct heap *h) 
+{
+  ASSERT (h != NULL);
+
+  return h->root;
+}
+
+/* Removes and returns the minimum element in H, which must not
+   be empty. */
+struct heap_elem *
+heap_pop_min (struct heap *h) 
+{
+  struct heap_elem *min;
+
+  ASSERT (h != NULL);
+  ASSERT (!heap_empty (h));
+
+  min = h->root;
+  h->root = link_pairs (h, min->child);
+  h->size--;
+
+  min->child = NULL;
+  return min;
+}
+
+/* Removes E, which must be in H, from H. */
+void
+heap_remove (struct heap *h, struct heap_elem *e) 
+{
+  struct heap_elem *children;
+
+  ASSERT (h != NULL);
+  ASSERT (e != NULL);
+
+  if (e == h->root)
+    {
+      heap_pop_min (h);
+      return;
+    }
+
+  /* Cut the subtree rooted at E out of the tree. */
+  ASSERT (e->prev != NULL);
+  if (e->prev->child == e)
+    e->prev->child = e->next;
+  else
+    e->prev->next = e->next;
+  if (e->next != NULL)
+    e->next->prev = e->prev;
+
+  /* Combine E's children and link them back in. */
+  children = link_pairs (h, e->child);
+  h->root = link (h, h->root, children);
+  h->size--;
+
+  e->child = e->next = e->prev = NULL;
+}
+
+/* Returns the number of elements in H. */
+size_t
+heap_size (const struct heap *h) 
+{
+  ASSERT (h != NULL);
+
+  return h->size;
+}
+
+/* Returns true if H is empty, false otherwise. */
+bool
+heap_empty (const struct heap *h) 
+{
+  ASSERT (h != NULL);
+
+  return h->root == NULL;
+}
+
+/* Links the trees rooted at A and B, either of which may be
+   null, by making the greater root the leftmost child of the
+   lesser.  A and B must not have siblings.  Returns the root of
+   the combined tree. */
+static struct heap_elem *
+link (struct heap *h, struct heap_elem *a, struct heap_elem *b) 
+{
+  if (a == NULL)
+    return b;
+  if (b == NULL)
+    return a;
+
+  if (h->less (b, a, h->aux))
+    {
+      struct heap_elem *t = a;
+      a = b;
+      b = t;
+    }
+
+  b->prev = a;
+  b->next = a->child;
+  if (a->child != NULL)
+    a->child->prev = b;
+  a->child = b;
+  return a;
+}
+
+/* Combines FIRST and its right siblings into a single tree, by
+   linking them in pairs from left to right and then linking the
+   resulting trees from right to left, and returns its root.
+   Returns a null pointer if FIRST is null. */
+static struct heap_elem *
+link_pairs (struct heap *h, struct heap_elem *first) 
+{
+  struct heap_elem *pairs = NULL;
+  struct heap_elem *root = NULL;
+
+  /* First pass, left to right.  The linked pairs are chained
+     through `next' in reverse order, ready for the second
+     pass. */
+  while (first != NULL)
+    {
+      struct heap_elem *a = first;
+      struct heap_elem *b = a->next;
+
+      first = b != NULL ? b->next : NULL;
+      a->next = a->prev = NULL;
+      if (b != NULL)
+        b->next = b->prev = NULL;
+
+      a = link (h, a, b);
+      a->next = pairs;
+      pairs = a;
+    }
+
+  /* Second pass, right to left. */
+  while (pairs != NULL)
+    {
+      struct heap_elem *next = pairs->next;
+
+      pairs->next = NULL;
+      root = link (h, root, pairs);
+      pairs = next;
+    }
+  return root;
+}
@@ -0,0 +1,77 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Priority queue, implemented as a pairing heap.
+
+   Like the linked list in list.h, this heap does not allocate
+   memory.  Each structure that can be in a heap must embed a
+   struct heap_elem member, and the heap_entry macro converts a
+   struct heap_elem back to the structure that contains it.  See
+   lib/kernel/list.h for a detailed explanation of the technique.
+
+   The order of the elements is given by a heap_less_func
+   supplied to heap_init(), and heap_min() returns an element
+   that no other element is less than.  Inserting and finding
+   the minimum take constant time; removing the minimum, or any
+   other element, takes O(lg n) amortized time.  Equal elements
+   come out in no particular order.
+
+   A pairing heap is a tree in which every node is no greater
+   than its children.  Each node points to its leftmost child
+   and to its right sibling, and back to its left sibling or, if
+   it is the leftmost child, to its parent.  Insertion links the
+   new node and the root, making the greater of the two a child
+   of the lesser.  Removing the root combines its children into
+   a new tree by linking them in pairs from left to right, then
+   linking the pairs from right to left.
+
+   To change the key of an element that is in a heap, remove it,
+   change the key, and insert it again. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem 
+  {
+    struct heap_elem *child;    /* Leftmost child. */
+    struct heap_elem *next;     /* Right sibling. */
+    struct heap_elem *prev;     /* Left sibling, or parent. */
+  };
+
+/* Compares the value of two heap elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool heap_less_func (const struct heap_elem *a,
+                             const struct heap_elem *b,
+                             void *aux);
+
+/* Heap. */
+struct heap 
+  {
+    struct heap_elem *root;     /* Minimum element, or null. */
+    size_t size;                /* Number of elements. */
+    heap_less_func *less;       /* Comparison function. */
+    void *aux;                  /* Auxiliary data for `less'. */
+  };
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+   the structure that HEAP_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the heap element. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)                   \
+        ((STRUCT *) ((uint8_t *) &(HEAP_ELEM)->child            \
+                     - offsetof (STRUCT, MEMBER.child)))
+
+void heap_init (struct heap *, heap_less_func *, void *aux);
+
+void heap_insert (struct heap *, struct heap_elem *);
+struct heap_elem *heap_min (const struct heap *);
+struct heap_elem *heap_pop_min (struct heap *);
+void heap_remove (struct heap *, struct heap_elem *);
+
+size_t heap_size (const struct heap *);
+bool heap_empty (const struct heap *);
+
+#endif /* lib/kernel/heap.h */
@@ -0,0 +1,159 @@
+#include "ring.h"
+#include "../debug.h"
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+
+/* The single-producer, single-consumer protocol only needs
+   barrier() to keep the compiler from moving the copies across
+   the updates of HEAD and TAIL: an 80x86 does not reorder stores
+   with older stores, nor loads with older loads. */
+
+static void copy_in (struct ring *, size_t pos, const void *, size_t cnt);
+static void copy_out (const struct ring *, size_t pos, void *, size_t cnt);
+
+/* Initializes RING to use BUF, which must hold CAPACITY elements
+   of ELEM_SIZE bytes each.  CAPACITY must be a power of two. */
+void
+ring_init (struct ring *ring, void *buf, size_t capacity, size_t elem_size) 
+{
+  ASSERT (ring != NULL);
+  ASSERT (buf != NULL);
+  ASSERT (capacity > 0 && (capacity & (capacity - 1)) == 0);
+  ASSERT (elem_size > 0);
+
+  ring->buf = buf;
+  ring->elem_size = elem_size;
+  ring->mask = capacity - 1;
+  ring->head = ring->tail = 0;
+}
+
+/* Returns the number of elements RING can hold. */
+size_t
+ring_capacity (const struct ring *ring) 
+{
+  return ring->mask + 1;
+}
+
+/* Returns the number of elements in RING.  If the producer or
+   consumer is running concurrently, the result may already be
+   out of date, but only in the direction that the caller's own
+   side cannot be hurt by: a producer never sees less space than
+   it has, and a consumer never sees more elements. */
+size_t
+ring_count (const struct ring *ring) 
+{
+  return ring->head - ring->tail;
+}
+
+/* Returns the number of elements that can be added to RING. */
+size_t
+ring_space (const struct ring *ring) 
+{
+  return ring_capacity (ring) - ring_count (ring);
+}
+
+/* Returns true if RING holds no elements. */
+bool
+ring_empty (const struct ring *ring) 
+{
+  return ring->head == ring->tail;
+}
+
+/* Returns true if RING has no room for another element. */
+bool
+ring_full (const struct ring *ring) 
+{
+  return ring_count (ring) == ring_capacity (ring);
+}
+
+/* Adds up to CNT elements from ELEMS to RING, as many as fit,
+   and returns the number added.  Only one producer may call
+   this at a time. */
+size_t
+ring_put (struct ring *ring, const void *elems, size_t cnt) 
+{
+  size_t head = ring->head;
+
+  if (cnt > ring_space (ring))
+    cnt = ring_space (ring);
+  copy_in (ring, head, elems, cnt);
+
+  /* Publish the elements only after they have been written. */
+  barrier ();
+  ring->head = head + cnt;
+  return cnt;
+}
+
+/* Like ring_put(), but may be called by any number of producers
+   at once, including from interrupt handlers. */
+size_t
+ring_put_mp (struct ring *ring, const void *elems, size_t cnt) 
+{
+  enum intr_level old_level = intr_disable ();
+  cnt = ring_put (ring, elems, cnt);
+  intr_set_level (old_level);
+  return cnt;
+}
+
+/* Removes up to CNT elements from RING into ELEMS, as many as
+   there are, and returns the number removed.  Only one consumer
+   may call this at a time. */
+size_t
+ring_get (struct ring *ring, void *elems, size_t cnt) 
+{
+  size_t tail = ring->tail;
+
+  cnt = ring_peek (ring, elems, cnt);
+
+  /* Free the slots only after they have been read. */
+  barrier ();
+  ring->tail = tail + cnt;
+  return cnt;
+}
+
+/* Copies up to CNT elements from the front of RING into ELEMS,
+   without removing them, and returns the number copied. */
+size_t
+ring_peek (const struct ring *ring, void *elems, size_t cnt) 
+{
+  size_t tail = ring->tail;
+
+  if (cnt > ring_count (ring))
+    cnt = ring_count (ring);
+
+  /* Read the elements only after seeing HEAD cover them. */
+  barrier ();
+  copy_out (ring, tail, elems, cnt);
+  return cnt;
+}
+
+/* Copies CNT elements from ELEMS into RING's buffer, starting at
+   element POS, wrapping around at the end of the buffer. */
+static void
+copy_in (struct ring *ring, size_t pos, const void *elems, size_t cnt) 
+{
+  size_t ofs = pos & ring->mask;
+  size_t first = ring_capacity (ring) - ofs;
+
+  if (first > cnt)
+    first = cnt;
+  memcpy (ring->buf + ofs * ring->elem_size, elems, first * ring->elem_size);
+  memcpy (ring->buf, (const unsigned char *) elems + first * ring->elem_size,
+          (cnt - first) * ring->elem_size);
+}
+
+/* Copies CNT elements from RING's buffer into ELEMS, starting at
+   element POS, wrapping around at the end of the buffer. */
+static void
+copy_out (const struct ring *ring, size_t pos, void *elems, size_t cnt) 
+{
+  size_t ofs = pos & ring->mask;
+  size_t first = ring_capacity (ring) - ofs;
+
+  if (first > cnt)
+    first = cnt;
+  memcpy (elems, ring->buf + ofs * ring->elem_size, first * ring->elem_size);
+  memcpy ((unsigned char *) elems + first * ring->elem_size, ring->buf,
+          (cnt - first) * ring->elem_size);
+}
@@ -0,0 +1,52 @@
+#ifndef __LIB_KERNEL_RING_H
+#define __LIB_KERNEL_RING_H
+
+/* Ring buffer of fixed-size elements.
+
+   Like the other data structures in lib/kernel, a ring does not
+   allocate memory: the caller supplies a buffer that holds a
+   power-of-two number of elements.
+
+   With one producer and one consumer, no locking is needed:
+   only the producer writes HEAD and only the consumer writes
+   TAIL, each after it has finished with the elements it copied.
+   That holds even if one side is an interrupt handler and the
+   other a kernel thread, so neither needs to turn interrupts
+   off.  HEAD and TAIL count elements ever added and removed,
+   wrapping around freely; their difference is the number of
+   elements in the ring, so a ring can be completely full.
+
+   With several producers, use ring_put_mp(), which serializes
+   them by turning interrupts off.  Several consumers must
+   likewise be serialized by the caller.
+
+   The ring only copies data.  Blocking until there is data or
+   space is up to the caller; see devices/intq.h. */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* A ring buffer. */
+struct ring
+  {
+    unsigned char *buf;         /* Element storage. */
+    size_t elem_size;           /* Size of an element, in bytes. */
+    size_t mask;                /* Capacity minus 1. */
+    volatile size_t head;       /* Elements ever added. */
+    volatile size_t tail;       /* Elements ever removed. */
+  };
+
+void ring_init (struct ring *, void *buf, size_t capacity, size_t elem_size);
+
+size_t ring_capacity (const struct ring *);
+size_t ring_count (const struct ring *);
+size_t ring_space (const struct ring *);
+bool ring_empty (const struct ring *);
+bool ring_full (const struct ring *);
+
+size_t ring_put (struct ring *, const void *elems, size_t cnt);
+size_t ring_put_mp (struct ring *, const void *elems, size_t cnt);
+size_t ring_get (struct ring *, void *elems, size_t cnt);
+size_t ring_peek (const struct ring *, void *elems, size_t cnt);
+
+#endif /* lib/kernel/ring.h */
@@ -0,0 +1,29 @@
+#ifndef __LIB_SCHED_H
+#define __LIB_SCHED_H
+
+#include <stdint.h>
+
+/* Scheduling policies. */
+#define SCHED_OTHER 0           /* Normal, time-shared threads. */
+#define SCHED_FIFO 1            /* Real-time, run until blocked. */
+#define SCHED_RR 2              /* Real-time, round-robin. */
+#define SCHED_DEADLINE 3        /* Earliest deadline first. */
+
+/* Real-time priorities.  Every real-time thread runs ahead of
+   every SCHED_OTHER thread. */
+#define SCHED_RT_PRI_MIN 0      /* Lowest real-time priority. */
+#define SCHED_RT_PRI_MAX 31     /* Highest real-time priority. */
+
+/* Scheduling statistics for a thread, as reported by the
+   schedstat system call.  Times are in timer ticks. */
+struct schedstat
+  {
+    int64_t cpu_ticks;          /* Time spent running. */
+    int64_t ready_ticks;        /* Time spent ready, in the run queue. */
+    int64_t blocked_ticks;      /* Time spent blocked. */
+    int64_t last_run;           /* When the thread last started running. */
+    uint32_t voluntary_switches;   /* # of times it gave up the CPU. */
+    uint32_t involuntary_switches; /* # of times it was preempted. */
+  };
+
+#endif /* lib/sched.h */
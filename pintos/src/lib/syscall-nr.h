@@ -29,7 +29,19 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Scheduler extensions. */
+    SYS_NICE,                   /* Change the process's nice value. */
+    SYS_SCHEDSTAT,              /* Obtain scheduling statistics. */
+    SYS_SETSCHED,               /* Change scheduling policy. */
+    SYS_TICKETS,                /* Get or set stride scheduler tickets. */
+    SYS_SETDEADLINE,            /* Switch to SCHED_DEADLINE. */
+    SYS_LATDUMP,                /* Print wakeup latency histograms. */
+
+    /* User-space synchronization. */
+    SYS_FUTEX_WAIT,             /* Sleep if an int holds a value. */
+    SYS_FUTEX_WAKE              /* Wake threads sleeping on an int. */
   };
 
 #endif /* lib/syscall-nr.h */
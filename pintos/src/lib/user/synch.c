@@ -0,0 +1,226 @@
+#include <synch.h>
+#include <debug.h>
+#include <limits.h>
+#include <stddef.h>
+#include <syscall.h>
+
+/* Returns the value of *P, reading memory rather than a copy
+   the compiler might have kept in a register. */
+static inline int
+atomic_read (int *p)
+{
+  return *(volatile int *) p;
+}
+
+/* Atomically sets *P to NEW if it is OLD.  Returns the previous
+   value of *P, which equals OLD if and only if the exchange
+   happened. */
+static inline int
+atomic_cmpxchg (int *p, int old, int new)
+{
+  int prev;
+  asm volatile ("lock cmpxchgl %2, %1"
+                : "=a" (prev), "+m" (*p)
+                : "r" (new), "0" (old)
+                : "memory");
+  return prev;
+}
+
+/* Atomically sets *P to NEW and returns its previous value. */
+static inline int
+atomic_xchg (int *p, int new)
+{
+  asm volatile ("xchgl %0, %1" : "+r" (new), "+m" (*p) : : "memory");
+  return new;
+}
+
+/* Atomically adds DELTA to *P and returns its previous value. */
+static inline int
+atomic_add (int *p, int delta)
+{
+  asm volatile ("lock xaddl %0, %1" : "+r" (delta), "+m" (*p) : : "memory");
+  return delta;
+}
+
+/* Initializes MUTEX as unlocked. */
+void
+mutex_init (struct mutex *mutex)
+{
+  ASSERT (mutex != NULL);
+
+  mutex->state = 0;
+}
+
+/* Locks MUTEX, sleeping until it is free if necessary.
+
+   A locker that finds MUTEX held marks it as having waiters
+   (state 2) before sleeping, so that mutex_unlock() knows to
+   enter the kernel to wake it.  Because it cannot tell whether
+   it was the last waiter, it keeps the mark when it finally
+   gets MUTEX; at worst that costs one needless wakeup. */
+void
+mutex_lock (struct mutex *mutex)
+{
+  int state;
+
+  ASSERT (mutex != NULL);
+
+  state = atomic_cmpxchg (&mutex->state, 0, 1);
+  if (state == 0)
+    return;
+
+  if (state != 2)
+    state = atomic_xchg (&mutex->state, 2);
+  while (state != 0)
+    {
+      futex_wait (&mutex->state, 2);
+      state = atomic_xchg (&mutex->state, 2);
+    }
+}
+
+/* Locks MUTEX if it is free and returns true, otherwise returns
+   false without sleeping. */
+bool
+mutex_trylock (struct mutex *mutex)
+{
+  ASSERT (mutex != NULL);
+
+  return atomic_cmpxchg (&mutex->state, 0, 1) == 0;
+}
+
+/* Unlocks MUTEX, which the caller must hold, waking one waiter
+   if there are any. */
+void
+mutex_unlock (struct mutex *mutex)
+{
+  ASSERT (mutex != NULL);
+  ASSERT (atomic_read (&mutex->state) != 0);
+
+  if (atomic_xchg (&mutex->state, 0) == 2)
+    futex_wake (&mutex->state, 1);
+}
+
+/* Initializes condition variable COND. */
+void
+condvar_init (struct condvar *cond)
+{
+  ASSERT (cond != NULL);
+
+  cond->seq = 0;
+  cond->waiters = 0;
+}
+
+/* Atomically releases MUTEX and waits for COND to be signaled,
+   then reacquires MUTEX before returning.  MUTEX must be held.
+   As with any condition variable, the caller must recheck its
+   condition after waking up.
+
+   A signal that comes between releasing MUTEX and sleeping
+   changes SEQ, so futex_wait() returns at once instead of
+   missing it. */
+void
+condvar_wait (struct condvar *cond, struct mutex *mutex)
+{
+  int seq;
+
+  ASSERT (cond != NULL);
+  ASSERT (mutex != NULL);
+
+  seq = atomic_read (&cond->seq);
+  atomic_add (&cond->waiters, 1);
+  mutex_unlock (mutex);
+
+  futex_wait (&cond->seq, seq);
+  atomic_add (&cond->waiters, -1);
+
+  /* Other threads may still be waiting, so lock MUTEX as
+     contended, to make sure whoever unlocks it next wakes one of
+     them. */
+  while (atomic_xchg (&mutex->state, 2) != 0)
+    futex_wait (&mutex->state, 2);
+}
+
+/* Wakes one thread waiting on COND, if any. */
+void
+condvar_signal (struct condvar *cond)
+{
+  ASSERT (cond != NULL);
+
+  if (atomic_read (&cond->waiters) > 0)
+    {
+      atomic_add (&cond->seq, 1);
+      futex_wake (&cond->seq, 1);
+    }
+}
+
+/* Wakes all threads waiting on COND. */
+void
+condvar_broadcast (struct condvar *cond)
+{
+  ASSERT (cond != NULL);
+
+  if (atomic_read (&cond->waiters) > 0)
+    {
+      atomic_add (&cond->seq, 1);
+      futex_wake (&cond->seq, INT_MAX);
+    }
+}
+
+/* Initializes SEMA to VALUE. */
+void
+sema_init (struct semaphore *sema, unsigned value)
+{
+  ASSERT (sema != NULL);
+  ASSERT (value <= INT_MAX);
+
+  sema->value = value;
+  sema->waiters = 0;
+}
+
+/* Waits for SEMA's value to become positive and then atomically
+   decrements it. */
+void
+sema_down (struct semaphore *sema)
+{
+  ASSERT (sema != NULL);
+
+  while (!sema_try_down (sema))
+    {
+      /* Sleep only while the value is still 0.  If sema_up()
+         raised it after we looked, futex_wait() returns at once
+         and we try again. */
+      atomic_add (&sema->waiters, 1);
+      futex_wait (&sema->value, 0);
+      atomic_add (&sema->waiters, -1);
+    }
+}
+
+/* Decrements SEMA's value if it is positive and returns true,
+   otherwise returns false without sleeping. */
+bool
+sema_try_down (struct semaphore *sema)
+{
+  int value;
+
+  ASSERT (sema != NULL);
+
+  for (value = atomic_read (&sema->value); value > 0; )
+    {
+      int prev = atomic_cmpxchg (&sema->value, value, value - 1);
+      if (prev == value)
+        return true;
+      value = prev;
+    }
+  return false;
+}
+
+/* Increments SEMA's value and wakes one sleeper, if any. */
+void
+sema_up (struct semaphore *sema)
+{
+  ASSERT (sema != NULL);
+
+  atomic_add (&sema->value, 1);
+  if (atomic_read (&sema->waiters) > 0)
+    futex_wake (&sema->value, 1);
+}
@@ -0,0 +1,56 @@
+#ifndef __LIB_USER_SYNCH_H
+#define __LIB_USER_SYNCH_H
+
+#include <stdbool.h>
+
+/* Synchronization primitives for user programs, built on atomic
+   instructions and the futex_wait() and futex_wake() system
+   calls.  Locking a free mutex, downing a positive semaphore,
+   and waking an object that nobody waits on all stay in user
+   space; only a thread that has to sleep, or has to wake a
+   sleeper, enters the kernel.
+
+   The objects are meant to be placed in memory shared between
+   processes, but Pintos cannot map memory shared yet, and a
+   process has only one thread.  Until it can, no other thread
+   can ever release an object that a process finds taken: a
+   contended mutex_lock(), sema_down() or condvar_wait() sleeps
+   in futex_wait() forever.  Only the uncontended paths are
+   usable. */
+
+/* Mutex. */
+struct mutex
+  {
+    int state;          /* 0: unlocked, 1: locked, 2: locked, waiters. */
+  };
+
+void mutex_init (struct mutex *);
+void mutex_lock (struct mutex *);
+bool mutex_trylock (struct mutex *);
+void mutex_unlock (struct mutex *);
+
+/* Condition variable. */
+struct condvar
+  {
+    int seq;            /* Bumped by every signal and broadcast. */
+    int waiters;        /* Number of threads in condvar_wait(). */
+  };
+
+void condvar_init (struct condvar *);
+void condvar_wait (struct condvar *, struct mutex *);
+void condvar_signal (struct condvar *);
+void condvar_broadcast (struct condvar *);
+
+/* Counting semaphore. */
+struct semaphore
+  {
+    int value;          /* Current value, never negative. */
+    int waiters;        /* Number of threads sleeping in sema_down(). */
+  };
+
+void sema_init (struct semaphore *, unsigned value);
+void sema_down (struct semaphore *);
+bool sema_try_down (struct semaphore *);
+void sema_up (struct semaphore *);
+
+#endif /* lib/user/synch.h */
@@ -189,3 +189,51 @@ inumber (int fd)
 {
   return syscall1 (SYS_INUMBER, fd);
 }
+
+int
+nice (int increment)
+{
+  return syscall1 (SYS_NICE, increment);
+}
+
+void
+schedstat (struct schedstat *stats)
+{
+  syscall1 (SYS_SCHEDSTAT, stats);
+}
+
+bool
+setsched (int policy, int rt_priority, int quantum)
+{
+  return syscall3 (SYS_SETSCHED, policy, rt_priority, quantum);
+}
+
+int
+tickets (int new_tickets)
+{
+  return syscall1 (SYS_TICKETS, new_tickets);
+}
+
+bool
+setdeadline (int runtime, int period, int deadline)
+{
+  return syscall3 (SYS_SETDEADLINE, runtime, period, deadline);
+}
+
+void
+latdump (void)
+{
+  syscall0 (SYS_LATDUMP);
+}
+
+int
+futex_wait (int *addr, int expected)
+{
+  return syscall2 (SYS_FUTEX_WAIT, addr, expected);
+}
+
+int
+futex_wake (int *addr, int cnt)
+{
+  return syscall2 (SYS_FUTEX_WAKE, addr, cnt);
+}
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <debug.h>
+#include <sched.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -45,4 +46,17 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Scheduler extensions.  setsched() refuses SCHED_FIFO and
+   SCHED_RR unless the kernel was started with -user-rt. */
+int nice (int increment);
+void schedstat (struct schedstat *);
+bool setsched (int policy, int rt_priority, int quantum);
+int tickets (int new_tickets);
+bool setdeadline (int runtime, int period, int deadline);
+void latdump (void);
+
+/* User-space synchronization. */
+int futex_wait (int *addr, int expected);
+int futex_wake (int *addr, int cnt);
+
 #endif /* lib/user/syscall.h */
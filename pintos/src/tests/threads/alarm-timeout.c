@@ -0,0 +1,83 @@
+/* Tests sema_down_timeout() and cond_wait_timeout(): a wait
+   with nobody to wake it up must give up after the timeout, and
+   a wait that is woken up in time must succeed without waiting
+   for the timeout. */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static thread_func sema_upper_thread;
+static thread_func cond_signaler_thread;
+static struct semaphore sema;
+static struct lock lock;
+static struct condition condition;
+
+void
+test_alarm_timeout (void) 
+{
+  int64_t start;
+
+  sema_init (&sema, 0);
+  lock_init (&lock);
+  cond_init (&condition);
+
+  start = timer_ticks ();
+  if (sema_down_timeout (&sema, 10))
+    fail ("sema_down_timeout succeeded with nobody to up the semaphore");
+  if (timer_elapsed (start) < 10)
+    fail ("sema_down_timeout gave up after only %"PRId64" ticks",
+          timer_elapsed (start));
+  msg ("sema_down_timeout timed out.");
+
+  start = timer_ticks ();
+  thread_create ("upper", PRI_DEFAULT, sema_upper_thread, NULL);
+  if (!sema_down_timeout (&sema, 1000))
+    fail ("sema_down_timeout timed out although the semaphore was upped");
+  if (timer_elapsed (start) >= 1000)
+    fail ("sema_down_timeout waited for the whole timeout");
+  msg ("sema_down_timeout woke up.");
+
+  lock_acquire (&lock);
+  start = timer_ticks ();
+  if (cond_wait_timeout (&condition, &lock, 10))
+    fail ("cond_wait_timeout succeeded with nobody to signal");
+  if (timer_elapsed (start) < 10)
+    fail ("cond_wait_timeout gave up after only %"PRId64" ticks",
+          timer_elapsed (start));
+  if (!lock_held_by_current_thread (&lock))
+    fail ("cond_wait_timeout returned without the lock");
+  msg ("cond_wait_timeout timed out.");
+
+  start = timer_ticks ();
+  thread_create ("signaler", PRI_DEFAULT, cond_signaler_thread, NULL);
+  if (!cond_wait_timeout (&condition, &lock, 1000))
+    fail ("cond_wait_timeout timed out although it was signaled");
+  if (timer_elapsed (start) >= 1000)
+    fail ("cond_wait_timeout waited for the whole timeout");
+  lock_release (&lock);
+  msg ("cond_wait_timeout woke up.");
+
+  pass ();
+}
+
+static void
+sema_upper_thread (void *aux UNUSED) 
+{
+  timer_sleep (5);
+  sema_up (&sema);
+}
+
+static void
+cond_signaler_thread (void *aux UNUSED) 
+{
+  timer_sleep (5);
+  lock_acquire (&lock);
+  cond_signal (&condition, &lock);
+  lock_release (&lock);
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-timeout) begin
+(alarm-timeout) sema_down_timeout timed out.
+(alarm-timeout) sema_down_timeout woke up.
+(alarm-timeout) cond_wait_timeout timed out.
+(alarm-timeout) cond_wait_timeout woke up.
+(alarm-timeout) PASS
+(alarm-timeout) end
+EOF
+pass;
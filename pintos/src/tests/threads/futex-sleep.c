@@ -0,0 +1,81 @@
+/* Tests futex_sleep() and futex_wakeup() on a kernel int shared
+   by kernel threads.  Checks that a waiter really sleeps until
+   it is woken, that waiters are woken highest priority first,
+   and that a waiter whose expected value is out of date does
+   not sleep, so that a wakeup issued after the value changed
+   cannot be lost. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/futex.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func sleeper;
+
+/* The futex word. */
+static int word;
+
+/* Upped by each sleeper when it finishes. */
+static struct semaphore done;
+
+void
+test_futex_sleep (void) 
+{
+  static const int order[] = {1, 3, 2};
+  int seen;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done, 0);
+
+  /* A sleeper with a higher priority runs at once and sleeps, so
+     control comes back here. */
+  word = 0;
+  thread_create ("single", PRI_DEFAULT + 1, sleeper, NULL);
+  msg ("Main thread runs while \"single\" sleeps.");
+  word = 1;
+  msg ("futex_wakeup() woke %d thread(s).", futex_wakeup (&word, 1));
+  sema_down (&done);
+
+  /* Three sleepers, woken one at a time. */
+  word = 0;
+  for (i = 0; i < 3; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "priority %d", PRI_DEFAULT + order[i]);
+      thread_create (name, PRI_DEFAULT + order[i], sleeper, NULL);
+    }
+  word = 1;
+  for (i = 0; i < 3; i++) 
+    {
+      futex_wakeup (&word, 1);
+      msg ("Back in main thread.");
+    }
+  for (i = 0; i < 3; i++)
+    sema_down (&done);
+
+  /* Nobody is left to wake. */
+  msg ("futex_wakeup() woke %d thread(s).", futex_wakeup (&word, 1));
+
+  /* A waiter that read the old value, then lost the race with a
+     change and its futex_wakeup(), must not sleep. */
+  seen = word;
+  word = 2;
+  futex_wakeup (&word, 1);
+  msg ("futex_sleep() with a stale value %s.",
+       futex_sleep (&word, seen) ? "slept" : "returned at once");
+}
+
+static void
+sleeper (void *aux UNUSED) 
+{
+  msg ("Thread %s sleeps.", thread_name ());
+  if (futex_sleep (&word, 0))
+    msg ("Thread %s woke up.", thread_name ());
+  else
+    msg ("Thread %s did not sleep.", thread_name ());
+  sema_up (&done);
+}
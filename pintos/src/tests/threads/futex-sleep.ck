@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-sleep) begin
+(futex-sleep) Thread single sleeps.
+(futex-sleep) Main thread runs while "single" sleeps.
+(futex-sleep) Thread single woke up.
+(futex-sleep) futex_wakeup() woke 1 thread(s).
+(futex-sleep) Thread priority 32 sleeps.
+(futex-sleep) Thread priority 34 sleeps.
+(futex-sleep) Thread priority 33 sleeps.
+(futex-sleep) Thread priority 34 woke up.
+(futex-sleep) Back in main thread.
+(futex-sleep) Thread priority 33 woke up.
+(futex-sleep) Back in main thread.
+(futex-sleep) Thread priority 32 woke up.
+(futex-sleep) Back in main thread.
+(futex-sleep) futex_wakeup() woke 0 thread(s).
+(futex-sleep) futex_sleep() with a stale value returned at once.
+(futex-sleep) end
+EOF
+pass;
@@ -0,0 +1,57 @@
+/* Tests the lock contention profiler: a lock acquired once
+   without waiting and once by a thread that had to wait shows
+   two acquisitions, one contended, with the waiting thread as
+   its top waiter.  The full statistics are printed at
+   shutdown. */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/lockstat.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func waiter;
+
+static struct lock lock;
+
+void
+test_lockstat (void) 
+{
+  struct lockstat_class *c;
+  tid_t tid;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  lockstat_enabled = true;
+  lock_init_named (&lock, "lockstat test");
+  c = lockstat_class ("lockstat test");
+  ASSERT (c != NULL);
+
+  lock_acquire (&lock);
+  tid = thread_create ("waiter", PRI_DEFAULT + 1, waiter, NULL);
+  lock_release (&lock);
+
+  msg ("%"PRIu32" acquisitions, %"PRIu32" contended.",
+       c->acquired, c->contended);
+  if (c->wait_total == 0 || c->wait_max != c->wait_total)
+    fail ("wait time not recorded");
+  if (c->hold_total == 0)
+    fail ("hold time not recorded");
+  if (c->top[0].tid != tid || c->top[0].waits != 1)
+    fail ("waiter not recorded");
+  msg ("Top waiter is %s.", c->top[0].name);
+}
+
+static void
+waiter (void *aux UNUSED) 
+{
+  lock_acquire (&lock);
+  msg ("Waiter got the lock.");
+  lock_release (&lock);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(lockstat) begin
+(lockstat) Waiter got the lock.
+(lockstat) 2 acquisitions, 1 contended.
+(lockstat) Top waiter is waiter.
+(lockstat) end
+EOF
+pass;
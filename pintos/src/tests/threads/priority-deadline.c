@@ -0,0 +1,91 @@
+/* Checks SCHED_DEADLINE admission control and budget
+   enforcement.  A deadline thread with a budget of 5 ticks every
+   20 ticks spins for 3 periods.  It must get about 15 ticks of
+   CPU time, with the rest left for the (normal priority) main
+   thread, even though the main thread has a lower priority. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define RUNTIME 5
+#define PERIOD 20
+#define PERIOD_CNT 3
+
+struct deadline_info
+  {
+    struct semaphore done;      /* Upped when the thread is done. */
+    int64_t end;                /* When the thread stops spinning. */
+    int ticks;                  /* Ticks the thread ran. */
+  };
+
+static thread_func deadline_thread;
+static int spin_until (int64_t end);
+
+void
+test_priority_deadline (void) 
+{
+  struct deadline_info info;
+  int main_ticks;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  msg ("Invalid parameters rejected: %s.",
+       thread_set_deadline (RUNTIME, PERIOD, PERIOD / 2) ? "no" : "yes");
+  msg ("96%% bandwidth rejected: %s.",
+       thread_set_deadline (96, 100, 100) ? "no" : "yes");
+
+  sema_init (&info.done, 0);
+  info.end = timer_ticks () + PERIOD * PERIOD_CNT;
+  info.ticks = 0;
+  thread_create ("deadline", PRI_MAX, deadline_thread, &info);
+
+  /* The deadline thread runs first, because it has priority
+     PRI_MAX, and then keeps running as a SCHED_DEADLINE thread,
+     until it is throttled. */
+  main_ticks = spin_until (info.end);
+  sema_down (&info.done);
+
+  if (info.ticks < (RUNTIME - 1) * PERIOD_CNT
+      || info.ticks > (RUNTIME + 1) * PERIOD_CNT)
+    fail ("deadline thread ran %d ticks, expected about %d",
+          info.ticks, RUNTIME * PERIOD_CNT);
+  msg ("Deadline thread ran for its budget.");
+  if (main_ticks < (PERIOD - RUNTIME - 1) * PERIOD_CNT)
+    fail ("main thread ran %d ticks, expected about %d",
+          main_ticks, (PERIOD - RUNTIME) * PERIOD_CNT);
+  msg ("Main thread ran for the rest.");
+}
+
+static void
+deadline_thread (void *info_) 
+{
+  struct deadline_info *info = info_;
+
+  if (!thread_set_deadline (RUNTIME, PERIOD, PERIOD))
+    fail ("deadline thread not admitted");
+  info->ticks = spin_until (info->end);
+  sema_up (&info->done);
+}
+
+/* Spins until tick END.  Returns the number of ticks during
+   which the running thread ran. */
+static int
+spin_until (int64_t end) 
+{
+  int64_t last = timer_ticks ();
+  int ticks = 0;
+
+  while (last < end)
+    {
+      int64_t now = timer_ticks ();
+      if (now != last)
+        ticks++;
+      last = now;
+    }
+  return ticks;
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-deadline) begin
+(priority-deadline) Invalid parameters rejected: yes.
+(priority-deadline) 96% bandwidth rejected: yes.
+(priority-deadline) Deadline thread ran for its budget.
+(priority-deadline) Main thread ran for the rest.
+(priority-deadline) end
+EOF
+pass;
@@ -0,0 +1,97 @@
+/* The main thread acquires lock A.  Thread "low" acquires lock B
+   and then blocks on A, and thread "medium" also blocks on A.
+   Thread "high" blocks on B, donating through "low" to the main
+   thread.
+
+   When the main thread releases A, "low" gets it, because of the
+   priority "high" donated.  "medium" is still waiting for A, so
+   it must now donate to "low".  When "low" releases B and loses
+   the donation from "high", it should keep "medium"'s priority,
+   and thus run ahead of thread "busy", until it releases A. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+struct locks 
+  {
+    struct lock a;
+    struct lock b;
+  };
+
+static thread_func low_thread_func;
+static thread_func medium_thread_func;
+static thread_func high_thread_func;
+static thread_func busy_thread_func;
+
+void
+test_priority_donate_handoff (void) 
+{
+  struct locks locks;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  lock_init (&locks.a);
+  lock_init (&locks.b);
+  lock_acquire (&locks.a);
+
+  thread_create ("low", PRI_DEFAULT + 1, low_thread_func, &locks);
+  thread_create ("medium", PRI_DEFAULT + 5, medium_thread_func, &locks);
+  thread_create ("high", PRI_DEFAULT + 9, high_thread_func, &locks);
+  thread_create ("busy", PRI_DEFAULT + 3, busy_thread_func, NULL);
+  msg ("Main thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 9, thread_get_priority ());
+
+  lock_release (&locks.a);
+  msg ("Main thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT, thread_get_priority ());
+}
+
+static void
+low_thread_func (void *locks_) 
+{
+  struct locks *locks = locks_;
+
+  lock_acquire (&locks->b);
+  lock_acquire (&locks->a);
+  msg ("low: got a");
+  lock_release (&locks->b);
+  msg ("Low thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 5, thread_get_priority ());
+  lock_release (&locks->a);
+  msg ("low: done");
+}
+
+static void
+medium_thread_func (void *locks_) 
+{
+  struct locks *locks = locks_;
+
+  lock_acquire (&locks->a);
+  msg ("medium: got a");
+  lock_release (&locks->a);
+  msg ("medium: done");
+}
+
+static void
+high_thread_func (void *locks_) 
+{
+  struct locks *locks = locks_;
+
+  lock_acquire (&locks->b);
+  msg ("high: got b");
+  lock_release (&locks->b);
+  msg ("high: done");
+}
+
+static void
+busy_thread_func (void *aux UNUSED) 
+{
+  msg ("busy: running");
+}
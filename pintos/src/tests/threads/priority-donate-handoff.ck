@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-donate-handoff) begin
+(priority-donate-handoff) Main thread should have priority 40.  Actual priority: 40.
+(priority-donate-handoff) low: got a
+(priority-donate-handoff) high: got b
+(priority-donate-handoff) high: done
+(priority-donate-handoff) Low thread should have priority 36.  Actual priority: 36.
+(priority-donate-handoff) medium: got a
+(priority-donate-handoff) medium: done
+(priority-donate-handoff) busy: running
+(priority-donate-handoff) low: done
+(priority-donate-handoff) Main thread should have priority 31.  Actual priority: 31.
+(priority-donate-handoff) end
+EOF
+pass;
@@ -0,0 +1,54 @@
+/* Checks that a higher-priority thread that becomes ready while
+   preemption is disabled runs as soon as preemption is enabled
+   again, not before, and that cond_resched() is a preemption
+   point for a thread woken while interrupts were off. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func high_thread;
+static struct semaphore sema;
+static bool high_ran;
+
+void
+test_priority_preempt_disable (void) 
+{
+  enum intr_level old_level;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  sema_init (&sema, 0);
+
+  preempt_disable ();
+  thread_create ("high", PRI_DEFAULT + 1, high_thread, NULL);
+  msg ("High-priority thread has %srun.", high_ran ? "" : "not ");
+  thread_yield_preempted ();
+  msg ("High-priority thread has %srun.", high_ran ? "" : "not ");
+  preempt_enable ();
+  msg ("High-priority thread has %srun.", high_ran ? "" : "not ");
+
+  /* Wake the thread with interrupts off, then turn them back on
+     without calling thread_preempt(). */
+  high_ran = false;
+  old_level = intr_disable ();
+  sema_up (&sema);
+  intr_set_level (old_level);
+  cond_resched ();
+  msg ("High-priority thread has %srun.", high_ran ? "" : "not ");
+}
+
+static void
+high_thread (void *aux UNUSED) 
+{
+  high_ran = true;
+  sema_down (&sema);
+  high_ran = true;
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-preempt-disable) begin
+(priority-preempt-disable) High-priority thread has not run.
+(priority-preempt-disable) High-priority thread has not run.
+(priority-preempt-disable) High-priority thread has run.
+(priority-preempt-disable) High-priority thread has run.
+(priority-preempt-disable) end
+EOF
+pass;
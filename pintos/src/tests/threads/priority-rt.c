@@ -0,0 +1,48 @@
+/* Checks that a real-time thread runs ahead of a normal thread
+   of any priority, that SCHED_FIFO threads are not time-sliced,
+   and that returning to SCHED_OTHER lets the normal thread
+   preempt. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static thread_func normal_thread;
+
+void
+test_priority_rt (void) 
+{
+  int64_t start;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  msg ("Invalid real-time priority rejected: %s.",
+       thread_set_policy (SCHED_FIFO, SCHED_RT_PRI_MAX + 1, 0)
+       ? "no" : "yes");
+
+  thread_set_policy (SCHED_FIFO, SCHED_RT_PRI_MIN, 0);
+  msg ("Main thread is SCHED_FIFO.");
+
+  thread_create ("normal", PRI_MAX, normal_thread, NULL);
+  msg ("Created a normal thread at PRI_MAX.");
+
+  /* Spin for several time slices.  A SCHED_FIFO thread is never
+     preempted by a lower-priority thread, so the normal thread
+     must not run during this loop. */
+  start = timer_ticks ();
+  while (timer_elapsed (start) < 4 * TIMER_FREQ / 10)
+    continue;
+  msg ("Main thread spun without being preempted.");
+
+  thread_set_policy (SCHED_OTHER, 0, 0);
+  msg ("Main thread is back to SCHED_OTHER.");
+}
+
+static void
+normal_thread (void *aux UNUSED) 
+{
+  msg ("Normal thread running.");
+}
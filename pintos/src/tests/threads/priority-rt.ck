@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-rt) begin
+(priority-rt) Invalid real-time priority rejected: yes.
+(priority-rt) Main thread is SCHED_FIFO.
+(priority-rt) Created a normal thread at PRI_MAX.
+(priority-rt) Main thread spun without being preempted.
+(priority-rt) Normal thread running.
+(priority-rt) Main thread is back to SCHED_OTHER.
+(priority-rt) end
+EOF
+pass;
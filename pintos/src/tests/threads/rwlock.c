@@ -0,0 +1,76 @@
+/* Tests reader-writer locks: readers share the lock, a waiting
+   writer holds off new readers and gets the lock before them,
+   and a lone reader can upgrade to a writer and downgrade
+   back. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func reader;
+static thread_func writer;
+
+static struct rwlock rwlock;
+
+void
+test_rwlock (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rwlock);
+  rwlock_acquire_read (&rwlock);
+  msg ("main reading.");
+
+  /* A second reader gets in alongside us. */
+  thread_create ("reader-a", PRI_DEFAULT + 1, reader, "reader-a");
+
+  /* A writer has to wait for us, and a reader that comes after
+     it has to wait for the writer. */
+  thread_create ("writer", PRI_DEFAULT + 2, writer, "writer");
+  thread_create ("reader-b", PRI_DEFAULT + 1, reader, "reader-b");
+  msg ("main releasing.");
+  rwlock_release_read (&rwlock);
+
+  /* With no one else around, upgrading succeeds at once, and
+     after downgrading, other readers get in again. */
+  rwlock_acquire_read (&rwlock);
+  msg ("main upgrading.");
+  if (rwlock_upgrade (&rwlock))
+    msg ("main writing.");
+  else
+    fail ("upgrade failed with no other readers");
+  rwlock_downgrade (&rwlock);
+  thread_create ("reader-c", PRI_DEFAULT + 1, reader, "reader-c");
+  rwlock_release_read (&rwlock);
+  msg ("main done.");
+}
+
+static void
+reader (void *name_) 
+{
+  const char *name = name_;
+
+  msg ("%s acquiring.", name);
+  rwlock_acquire_read (&rwlock);
+  msg ("%s reading.", name);
+  rwlock_release_read (&rwlock);
+  msg ("%s done.", name);
+}
+
+static void
+writer (void *name_) 
+{
+  const char *name = name_;
+
+  msg ("%s acquiring.", name);
+  rwlock_acquire_write (&rwlock);
+  msg ("%s writing.", name);
+  rwlock_release_write (&rwlock);
+  msg ("%s done.", name);
+}
@@ -0,0 +1,26 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock) begin
+(rwlock) main reading.
+(rwlock) reader-a acquiring.
+(rwlock) reader-a reading.
+(rwlock) reader-a done.
+(rwlock) writer acquiring.
+(rwlock) reader-b acquiring.
+(rwlock) main releasing.
+(rwlock) writer writing.
+(rwlock) writer done.
+(rwlock) reader-b reading.
+(rwlock) reader-b done.
+(rwlock) main upgrading.
+(rwlock) main writing.
+(rwlock) reader-c acquiring.
+(rwlock) reader-c reading.
+(rwlock) reader-c done.
+(rwlock) main done.
+(rwlock) end
+EOF
+pass;
@@ -0,0 +1,90 @@
+/* Runs three CPU-bound threads holding 100, 200, and 300 tickets
+   under the stride scheduler for 10 seconds, and checks that
+   each receives a share of the CPU time in proportion to its
+   tickets, to within 5% of the total. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 3
+
+struct thread_info 
+  {
+    int64_t start_time;
+    int tickets;
+    int tick_count;
+  };
+
+static thread_func load_thread;
+
+void
+test_stride_share (void) 
+{
+  struct thread_info info[THREAD_CNT];
+  int64_t start_time;
+  int total_ticks, total_tickets;
+  int i;
+
+  ASSERT (thread_stride);
+
+  start_time = timer_ticks ();
+  msg ("Starting %d threads...", THREAD_CNT);
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      struct thread_info *ti = &info[i];
+      char name[16];
+
+      ti->start_time = start_time;
+      ti->tickets = (i + 1) * 100;
+      ti->tick_count = 0;
+
+      snprintf (name, sizeof name, "load %d", i);
+      thread_create (name, PRI_DEFAULT, load_thread, ti);
+    }
+
+  msg ("Sleeping 12 seconds to let threads run, please wait...");
+  timer_sleep (12 * TIMER_FREQ);
+
+  total_ticks = total_tickets = 0;
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      total_ticks += info[i].tick_count;
+      total_tickets += info[i].tickets;
+    }
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      int expected = total_ticks * info[i].tickets / total_tickets;
+      int error = info[i].tick_count - expected;
+
+      if (error < 0)
+        error = -error;
+      if (error * 20 > total_ticks)
+        fail ("thread %d with %d tickets received %d of %d ticks, "
+              "expected about %d", i, info[i].tickets,
+              info[i].tick_count, total_ticks, expected);
+      msg ("Thread %d received its share.", i);
+    }
+}
+
+static void
+load_thread (void *ti_) 
+{
+  struct thread_info *ti = ti_;
+  int64_t sleep_time = 1 * TIMER_FREQ;
+  int64_t spin_time = sleep_time + 10 * TIMER_FREQ;
+  int64_t last_time = 0;
+
+  thread_set_tickets (ti->tickets);
+  timer_sleep (sleep_time - timer_elapsed (ti->start_time));
+  while (timer_elapsed (ti->start_time) < spin_time) 
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        ti->tick_count++;
+      last_time = cur_time;
+    }
+}
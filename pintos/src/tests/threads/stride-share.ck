@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(stride-share) begin
+(stride-share) Starting 3 threads...
+(stride-share) Sleeping 12 seconds to let threads run, please wait...
+(stride-share) Thread 0 received its share.
+(stride-share) Thread 1 received its share.
+(stride-share) Thread 2 received its share.
+(stride-share) end
+EOF
+pass;
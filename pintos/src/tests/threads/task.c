@@ -0,0 +1,80 @@
+/* Tests stackless tasks: many tasks park on a semaphore, are
+   released one up at a time, sleep on the timer, and finish,
+   all on the executor threads. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/task.h"
+#include "threads/thread.h"
+
+#define TASK_CNT 1000
+
+/* A test task and its state. */
+struct test_task
+  {
+    struct task task;
+    int id;
+  };
+
+static task_func test_step;
+static task_func test_done;
+
+static struct semaphore go;        /* Upped once per task to release it. */
+static struct semaphore finished;  /* Upped as each task finishes. */
+static int woken_cnt;              /* Tasks past the await. */
+
+void
+test_task (void) 
+{
+  int i;
+
+  sema_init (&go, 0);
+  sema_init (&finished, 0);
+
+  msg ("Starting %d tasks.", TASK_CNT);
+  for (i = 0; i < TASK_CNT; i++)
+    {
+      struct test_task *tt = malloc (sizeof *tt);
+      ASSERT (tt != NULL);
+      tt->id = i;
+      task_init (&tt->task, test_step, test_done);
+      task_start (&tt->task);
+    }
+
+  /* Let the executors run every task up to its await. */
+  timer_sleep (10);
+  if (woken_cnt != 0)
+    fail ("%d tasks got past the await early", woken_cnt);
+
+  msg ("Releasing them.");
+  for (i = 0; i < TASK_CNT; i++)
+    sema_up (&go);
+  for (i = 0; i < TASK_CNT; i++)
+    sema_down (&finished);
+  if (woken_cnt != TASK_CNT)
+    fail ("%d tasks got past the await", woken_cnt);
+  msg ("All %d tasks finished.", TASK_CNT);
+}
+
+static void
+test_step (struct task *t) 
+{
+  struct test_task *tt = (struct test_task *) t;
+
+  TASK_BEGIN (t);
+  TASK_AWAIT (t, &go);
+  woken_cnt++;
+  TASK_SLEEP (t, 1 + tt->id % 3);
+  TASK_YIELD (t);
+  TASK_END (t);
+}
+
+static void
+test_done (struct task *t) 
+{
+  free (t);
+  sema_up (&finished);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(task) begin
+(task) Starting 1000 tasks.
+(task) Releasing them.
+(task) All 1000 tasks finished.
+(task) end
+EOF
+pass;
@@ -11,6 +11,7 @@ extern test_func test_alarm_simultaneous;
 extern test_func test_alarm_priority;
 extern test_func test_alarm_zero;
 extern test_func test_alarm_negative;
+extern test_func test_alarm_timeout;
 extern test_func test_priority_change;
 extern test_func test_priority_donate_one;
 extern test_func test_priority_donate_multiple;
@@ -18,11 +19,20 @@ extern test_func test_priority_donate_multiple2;
 extern test_func test_priority_donate_sema;
 extern test_func test_priority_donate_nest;
 extern test_func test_priority_donate_lower;
+extern test_func test_priority_donate_handoff;
 extern test_func test_priority_donate_chain;
 extern test_func test_priority_fifo;
 extern test_func test_priority_preempt;
+extern test_func test_priority_preempt_disable;
 extern test_func test_priority_sema;
 extern test_func test_priority_condvar;
+extern test_func test_priority_rt;
+extern test_func test_priority_deadline;
+extern test_func test_workqueue;
+extern test_func test_rwlock;
+extern test_func test_lockstat;
+extern test_func test_task;
+extern test_func test_futex_sleep;
 extern test_func test_mlfqs_load_1;
 extern test_func test_mlfqs_load_60;
 extern test_func test_mlfqs_load_avg;
@@ -32,6 +42,7 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_stride_share;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
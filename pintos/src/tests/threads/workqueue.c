@@ -0,0 +1,90 @@
+/* Tests workqueues: work queued from a thread and from an
+   interrupt handler runs in a worker thread, queueing work that
+   is already pending is coalesced, delayed work waits for its
+   delay, and flush_work() waits for work to finish. */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
+
+static work_func count_work;
+static timer_callback_func queue_from_interrupt;
+
+static struct work work;
+static struct delayed_work dwork;
+static int run_cnt;
+static bool ran_in_interrupt;
+static int64_t ran_at;
+
+void
+test_workqueue (void) 
+{
+  struct workqueue *wq;
+  struct timer_event event;
+  enum intr_level old_level;
+  int64_t start;
+
+  wq = workqueue_create ("test-wq", 2, PRI_DEFAULT + 1);
+  ASSERT (wq != NULL);
+
+  /* Queue the same work twice in a row.  The workers have a
+     higher priority than we do, but we turn interrupts off so
+     that neither can run before we are done. */
+  work_init (&work, count_work);
+  old_level = intr_disable ();
+  if (!queue_work (wq, &work))
+    fail ("queue_work failed on idle work");
+  if (queue_work (wq, &work))
+    fail ("queue_work succeeded on pending work");
+  intr_set_level (old_level);
+  flush_work (&work);
+  if (run_cnt != 1)
+    fail ("work ran %d times, expected once", run_cnt);
+  if (ran_in_interrupt)
+    fail ("work ran in interrupt context");
+  msg ("Pending work was coalesced.");
+
+  /* Queue work from a timer interrupt. */
+  timer_add (&event, timer_ticks () + 5, queue_from_interrupt, NULL);
+  timer_sleep (10);
+  flush_work (&work);
+  if (run_cnt != 2)
+    fail ("work queued from interrupt ran %d times, expected once",
+          run_cnt - 1);
+  msg ("Work queued from interrupt ran.");
+
+  /* Delayed work. */
+  delayed_work_init (&dwork, count_work);
+  start = timer_ticks ();
+  if (!queue_delayed_work (system_wq, &dwork, 10))
+    fail ("queue_delayed_work failed on idle work");
+  if (queue_delayed_work (system_wq, &dwork, 10))
+    fail ("queue_delayed_work succeeded on pending work");
+  flush_work (&dwork.work);
+  if (run_cnt != 3)
+    fail ("delayed work ran %d times, expected once", run_cnt - 2);
+  if (ran_at - start < 10)
+    fail ("delayed work ran after %"PRId64" ticks, expected 10",
+          ran_at - start);
+  msg ("Delayed work ran after its delay.");
+}
+
+static void
+count_work (struct work *w UNUSED) 
+{
+  run_cnt++;
+  ran_in_interrupt = ran_in_interrupt || intr_context ();
+  ran_at = timer_ticks ();
+}
+
+static void
+queue_from_interrupt (void *aux UNUSED) 
+{
+  if (!queue_work (system_wq, &work))
+    printf ("queue_work from interrupt failed\n");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workqueue) begin
+(workqueue) Pending work was coalesced.
+(workqueue) Work queued from interrupt ran.
+(workqueue) Delayed work ran after its delay.
+(workqueue) end
+EOF
+pass;
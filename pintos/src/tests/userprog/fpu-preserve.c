@@ -0,0 +1,83 @@
+/* Loads known values into an x87 register and, if the CPU has
+   SSE2, into an XMM register, then makes a read system call on
+   a file, which blocks on the disk, and checks that both
+   registers still hold their values afterward.
+
+   The first FPU instruction also faults into the kernel's #NM
+   handler, which has to allocate the process's FPU save area
+   without panicking. */
+
+#include <stdint.h>
+#include <string.h>
+#include <syscall-nr.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Returns true if CPUID reports SSE2. */
+static bool
+have_sse2 (void) 
+{
+  uint32_t eax = 1, ebx, ecx = 0, edx;
+
+  asm volatile ("cpuid"
+                : "+a" (eax), "=b" (ebx), "+c" (ecx), "=d" (edx));
+  return (edx & (1u << 26)) != 0;
+}
+
+void
+test_main (void) 
+{
+  static const uint8_t xmm_in[16] =
+    {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+     0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10};
+  uint8_t xmm_out[16];
+  double x87_in = 3.140625, x87_out = 0.0;
+  char buffer[sizeof sample - 1];
+  bool sse2 = have_sse2 ();
+  int handle, retval;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  /* The values must stay in the registers across the system
+     call, so load them, trap, and store them back all in one
+     asm statement.  The read arguments are in registers because
+     the pushes move the stack pointer.  User programs are built
+     with -msoft-float, so the compiler neither uses nor lets us
+     name XMM0 as a clobber. */
+  msg ("load registers and read \"sample.txt\"");
+  if (sse2)
+    asm volatile ("fldl %[x87_in]; movdqu %[xmm_in], %%xmm0; "
+                  "pushl %[size]; pushl %[buffer]; pushl %[handle]; "
+                  "pushl %[number]; int $0x30; addl $16, %%esp; "
+                  "fstpl %[x87_out]; movdqu %%xmm0, %[xmm_out]"
+                  : "=a" (retval), [x87_out] "=m" (x87_out),
+                    [xmm_out] "=m" (xmm_out)
+                  : [number] "i" (SYS_READ), [handle] "r" (handle),
+                    [buffer] "r" (buffer), [size] "r" (sizeof buffer),
+                    [x87_in] "m" (x87_in), [xmm_in] "m" (xmm_in)
+                  : "memory");
+  else
+    {
+      asm volatile ("fldl %[x87_in]; "
+                    "pushl %[size]; pushl %[buffer]; pushl %[handle]; "
+                    "pushl %[number]; int $0x30; addl $16, %%esp; "
+                    "fstpl %[x87_out]"
+                    : "=a" (retval), [x87_out] "=m" (x87_out)
+                    : [number] "i" (SYS_READ), [handle] "r" (handle),
+                      [buffer] "r" (buffer), [size] "r" (sizeof buffer),
+                      [x87_in] "m" (x87_in)
+                    : "memory");
+      memcpy (xmm_out, xmm_in, sizeof xmm_out);
+    }
+
+  if (retval != (int) sizeof buffer)
+    fail ("read() returned %d instead of %zu", retval, sizeof buffer);
+  if (memcmp (buffer, sample, sizeof buffer))
+    fail ("read() returned wrong data");
+  if (memcmp (&x87_out, &x87_in, sizeof x87_out))
+    fail ("x87 register changed across read()");
+  if (memcmp (xmm_out, xmm_in, sizeof xmm_out))
+    fail ("XMM register changed across read()");
+  msg ("registers preserved");
+}
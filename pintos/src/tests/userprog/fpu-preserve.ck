@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fpu-preserve) begin
+(fpu-preserve) open "sample.txt"
+(fpu-preserve) load registers and read "sample.txt"
+(fpu-preserve) registers preserved
+(fpu-preserve) end
+fpu-preserve: exit(0)
+EOF
+pass;
@@ -0,0 +1,44 @@
+/* Tests the futex system calls and the user-space mutex,
+   condition variable and semaphore built on them, within a
+   single process: none of the uncontended operations here may
+   sleep. */
+
+#include <synch.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct mutex mutex;
+  struct condvar cond;
+  struct semaphore sema;
+  int word = 1;
+
+  CHECK (futex_wait (&word, 0) == -1,
+         "futex_wait on a changed value returns at once");
+  CHECK (futex_wake (&word, 1) == 0, "futex_wake with no waiters");
+
+  mutex_init (&mutex);
+  mutex_lock (&mutex);
+  CHECK (!mutex_trylock (&mutex), "trylock of held mutex fails");
+  mutex_unlock (&mutex);
+  CHECK (mutex_trylock (&mutex), "trylock of free mutex succeeds");
+  mutex_unlock (&mutex);
+
+  condvar_init (&cond);
+  mutex_lock (&mutex);
+  condvar_signal (&cond);
+  condvar_broadcast (&cond);
+  mutex_unlock (&mutex);
+  msg ("signal and broadcast with no waiters");
+
+  sema_init (&sema, 2);
+  CHECK (sema_try_down (&sema), "first sema_try_down succeeds");
+  sema_down (&sema);
+  CHECK (!sema_try_down (&sema), "sema_try_down of zero fails");
+  sema_up (&sema);
+  sema_down (&sema);
+  msg ("sema_down after sema_up");
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex) begin
+(futex) futex_wait on a changed value returns at once
+(futex) futex_wake with no waiters
+(futex) trylock of held mutex fails
+(futex) trylock of free mutex succeeds
+(futex) signal and broadcast with no waiters
+(futex) first sema_try_down succeeds
+(futex) sema_try_down of zero fails
+(futex) sema_down after sema_up
+(futex) end
+futex: exit(0)
+EOF
+pass;
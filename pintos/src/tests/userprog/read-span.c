@@ -0,0 +1,19 @@
+/* Passes the read system call a buffer that starts at the top
+   of the user stack and runs past PHYS_BASE into kernel memory.
+   Only its first bytes are valid, so the process must be
+   terminated with -1 exit code, without the kernel writing any
+   of the data. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int handle;
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  read (handle, (char *) 0xc0000000 - 8, 123);
+  fail ("should not have survived read()");
+}
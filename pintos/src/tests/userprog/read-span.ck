@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(read-span) begin
+(read-span) open "sample.txt"
+read-span: exit(-1)
+EOF
+pass;
@@ -0,0 +1,21 @@
+/* Makes a few system calls, one of which fails, with the kernel
+   run with -strace and -sysstat.  The check script looks for the
+   traced calls and for the per-process counts printed at
+   exit. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[4];
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (read (handle, buf, sizeof buf) == (int) sizeof buf,
+         "read \"sample.txt\"");
+  close (handle);
+  CHECK (open ("no-such-file") == -1, "open \"no-such-file\"");
+}
@@ -0,0 +1,28 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+
+# These lines must appear in this order, among the test's own
+# output and the traces of its writes to the console.
+my (@expected) = (
+  qr/^strace: \d+ open\("sample\.txt"\) = \d+$/,
+  qr/^strace: \d+ read\(\d+, 0x[0-9a-f]+, 4\) = 4$/,
+  qr/^strace: \d+ close\(\d+\)$/,
+  qr/^strace: \d+ open\("no-such-file"\) = -1$/,
+  qr/^strace: \d+ exit\(0\) = \?$/,
+  qr/^strace: exit\(0\)$/,
+  qr/^Syscall: tid \d+ \(strace\):$/,
+  qr/^Syscall:\s+open\s+2 calls\s+1 errors/,
+  qr/^Syscall:\s+read\s+1 calls\s+0 errors/,
+);
+
+my ($i) = 0;
+foreach (@output) {
+  $i++ if $i < @expected && $_ =~ $expected[$i];
+}
+fail "Missing output line matching $expected[$i].\n" if $i < @expected;
+pass;
@@ -0,0 +1,328 @@
+#include "threads/cpu.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <packed.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/lapic.h"
+#include "devices/timer.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/loader.h"
+#include "threads/palloc.h"
+#include "threads/pte.h"
+#include "threads/spinlock.h"
+#include "threads/vaddr.h"
+
+/* Multiprocessor startup.
+
+   The processors in a PC are described by the BIOS in the
+   MultiProcessor Specification tables [MP].  One of them, the
+   bootstrap processor (BSP), runs the BIOS and then Pintos; the
+   others, the application processors (APs), sit halted until
+   the BSP sends each one an INIT and then a start-up
+   interprocessor interrupt through its local APIC.  The AP then
+   begins executing in real mode at the start of a page below
+   1 MB, for which ap-start.S provides the code.
+
+   Only the BSP runs threads.  The thread system, the device
+   drivers, and the file system all rely on disabling interrupts
+   for mutual exclusion, which does not exclude other CPUs, so an
+   AP that has come up parks itself with interrupts disabled
+   until those critical sections take spin locks as well. */
+
+/* MP floating pointer structure. */
+struct mp_float
+  {
+    char signature[4];          /* "_MP_". */
+    uint32_t config;            /* Physical address of MP config table. */
+    uint8_t length;             /* Structure length in 16-byte units. */
+    uint8_t revision;           /* MP Specification revision. */
+    uint8_t checksum;           /* Makes all bytes sum to 0. */
+    uint8_t features[5];        /* Default configuration, IMCR. */
+  }
+PACKED;
+
+/* MP configuration table header. */
+struct mp_config
+  {
+    char signature[4];          /* "PCMP". */
+    uint16_t length;            /* Base table length, in bytes. */
+    uint8_t revision;           /* MP Specification revision. */
+    uint8_t checksum;           /* Makes base table sum to 0. */
+    char oem_id[8];             /* OEM identifier. */
+    char product_id[12];        /* Product identifier. */
+    uint32_t oem_table;         /* Physical address of OEM table. */
+    uint16_t oem_length;        /* OEM table length. */
+    uint16_t entry_cnt;         /* Number of entries after header. */
+    uint32_t lapic;             /* Physical address of local APICs. */
+    uint16_t ext_length;        /* Extended table length. */
+    uint8_t ext_checksum;       /* Extended table checksum. */
+    uint8_t reserved;
+  }
+PACKED;
+
+/* MP configuration table processor entry.  All other entry types
+   are 8 bytes long. */
+struct mp_proc
+  {
+    uint8_t type;               /* MP_PROC. */
+    uint8_t apic_id;            /* Local APIC ID. */
+    uint8_t apic_version;       /* Local APIC version. */
+    uint8_t flags;              /* MP_PROC_* flags. */
+    uint32_t signature;         /* CPUID signature. */
+    uint32_t features;          /* CPUID feature flags. */
+    uint32_t reserved[2];
+  }
+PACKED;
+
+#define MP_PROC 0               /* Processor entry type. */
+#define MP_PROC_ENABLED 0x01    /* Processor is usable. */
+#define MP_PROC_BSP 0x02        /* Processor is the BSP. */
+
+/* Known CPUs.  Until cpu_init() runs, only the BSP is known. */
+static struct cpu cpus[CPU_MAX] = {{ 0, 0, true, true, NULL }};
+static int cpu_cnt = 1;
+
+/* Number of CPUs that are online, protected by cpu_lock. */
+static int online_cnt = 1;
+static struct spinlock cpu_lock = SPINLOCK_INITIALIZER;
+
+/* Code in ap-start.S. */
+extern char ap_start[], ap_start_end[];
+extern uint32_t ap_start_cr3, ap_start_esp;
+
+static struct mp_config *mp_find_config (void);
+static void mp_parse_config (struct mp_config *);
+static bool start_ap (struct cpu *, uint32_t *pd);
+
+/* Finds the CPUs listed in the BIOS's MP tables and starts each
+   of the APs.  Must be called with interrupts enabled, after
+   timer_calibrate() and before the first user process starts. */
+void
+cpu_init (void) 
+{
+  struct mp_config *config;
+  uint32_t *pd;
+  bool all_started = true;
+  int i;
+
+  ASSERT (intr_get_level () == INTR_ON);
+
+  config = mp_find_config ();
+  if (config == NULL) 
+    {
+      printf ("cpu: no MP configuration table, using 1 CPU\n");
+      return;
+    }
+  mp_parse_config (config);
+
+  /* The startup code must not overlap the loader, whose
+     command-line arguments are still in use. */
+  ASSERT (ap_start_end - ap_start <= LOADER_BASE - LOADER_AP_BASE);
+  memcpy (ptov (LOADER_AP_BASE), ap_start, ap_start_end - ap_start);
+
+  /* Page directory for starting APs: the kernel mapping plus an
+     identity mapping of the low 4 MB, which the startup code
+     runs in while it turns on paging. */
+  pd = palloc_get_page (PAL_ASSERT);
+  memcpy (pd, init_page_dir, PGSIZE);
+  pd[0] = pd[pd_no (PHYS_BASE)];
+
+  for (i = 0; i < cpu_cnt; i++) 
+    if (!cpus[i].bsp && !start_ap (&cpus[i], pd)) 
+      {
+        printf ("cpu%d: APIC ID %"PRIu8" did not start\n",
+                i, cpus[i].apic_id);
+        all_started = false;
+      }
+
+  /* An AP that missed its deadline might still be on its way
+     through the startup code, so keep its page directory. */
+  if (all_started)
+    palloc_free_page (pd);
+
+  printf ("cpu: %d of %d CPUs online\n", cpu_online_count (), cpu_cnt);
+}
+
+/* Returns the running CPU. */
+struct cpu *
+cpu_current (void) 
+{
+  uint8_t apic_id;
+  int i;
+
+  if (!lapic_present ())
+    return &cpus[0];
+
+  apic_id = lapic_id ();
+  for (i = 0; i < cpu_cnt; i++)
+    if (cpus[i].apic_id == apic_id)
+      return &cpus[i];
+  NOT_REACHED ();
+}
+
+/* Returns the number of CPUs known. */
+int
+cpu_count (void) 
+{
+  return cpu_cnt;
+}
+
+/* Returns the number of CPUs that are online. */
+int
+cpu_online_count (void) 
+{
+  int cnt;
+
+  spin_lock (&cpu_lock);
+  cnt = online_cnt;
+  spin_unlock (&cpu_lock);
+  return cnt;
+}
+
+/* Entry point for APs, called by ap-start.S on the stack that
+   start_ap() allocated.  Switches to the kernel page directory,
+   marks the CPU online, and parks it. */
+void
+cpu_ap_main (void) 
+{
+  struct cpu *c;
+
+  asm volatile ("movl %0, %%cr3" : : "r" (vtop (init_page_dir)) : "memory");
+  intr_load_idt ();
+  lapic_enable ();
+
+  c = cpu_current ();
+  spin_lock (&cpu_lock);
+  c->online = true;
+  online_cnt++;
+  spin_unlock (&cpu_lock);
+
+  for (;;)
+    asm volatile ("cli; hlt" : : : "memory");
+}
+
+/* Returns the sum of the SIZE bytes starting at P. */
+static uint8_t
+checksum (const void *p, size_t size) 
+{
+  const uint8_t *q = p;
+  uint8_t sum = 0;
+
+  while (size-- > 0)
+    sum += *q++;
+  return sum;
+}
+
+/* Searches SIZE bytes of physical memory starting at PADDR for
+   the MP floating pointer structure, which is aligned on a
+   16-byte boundary.  Returns the structure if found, otherwise a
+   null pointer. */
+static struct mp_float *
+mp_search (uintptr_t paddr, size_t size) 
+{
+  uint8_t *p = ptov (paddr);
+  uint8_t *end = p + size;
+
+  for (; p + sizeof (struct mp_float) <= end; p += 16)
+    if (!memcmp (p, "_MP_", 4) && checksum (p, sizeof (struct mp_float)) == 0)
+      return (struct mp_float *) p;
+  return NULL;
+}
+
+/* Finds the MP configuration table, looking for the floating
+   pointer structure in the first kB of the extended BIOS data
+   area, in the last kB of base memory, and in the BIOS ROM, in
+   that order [MP] 4.  Returns the table if found and valid,
+   otherwise a null pointer. */
+static struct mp_config *
+mp_find_config (void) 
+{
+  uintptr_t ebda = *(uint16_t *) ptov (0x40e) << 4;
+  uintptr_t base_top = *(uint16_t *) ptov (0x413) * 1024;
+  struct mp_float *mpf = NULL;
+  struct mp_config *config;
+
+  if (ebda != 0)
+    mpf = mp_search (ebda, 1024);
+  if (mpf == NULL)
+    mpf = mp_search (base_top - 1024, 1024);
+  if (mpf == NULL)
+    mpf = mp_search (0xf0000, 0x10000);
+  if (mpf == NULL || mpf->config == 0
+      || mpf->config >= init_ram_pages * PGSIZE)
+    return NULL;
+
+  config = ptov (mpf->config);
+  if (memcmp (config->signature, "PCMP", 4)
+      || checksum (config, config->length) != 0)
+    return NULL;
+  return config;
+}
+
+/* Maps the local APIC and fills in the CPU table from CONFIG. */
+static void
+mp_parse_config (struct mp_config *config) 
+{
+  uint8_t *p = (uint8_t *) (config + 1);
+  uint8_t *end = (uint8_t *) config + config->length;
+  uint8_t bsp_id;
+
+  lapic_init (config->lapic);
+  lapic_enable ();
+  bsp_id = lapic_id ();
+
+  /* The BSP stays in slot 0. */
+  cpus[0].apic_id = bsp_id;
+  while (p < end)
+    if (*p == MP_PROC) 
+      {
+        struct mp_proc *proc = (struct mp_proc *) p;
+        p += sizeof *proc;
+
+        if (!(proc->flags & MP_PROC_ENABLED) || proc->apic_id == bsp_id)
+          continue;
+        if (cpu_cnt >= CPU_MAX) 
+          {
+            printf ("cpu: ignoring APIC ID %"PRIu8", "
+                    "more than %d CPUs\n", proc->apic_id, CPU_MAX);
+            continue;
+          }
+        cpus[cpu_cnt].id = cpu_cnt;
+        cpus[cpu_cnt].apic_id = proc->apic_id;
+        cpu_cnt++;
+      }
+    else
+      p += 8;
+}
+
+/* Starts AP C with the INIT, start-up, start-up sequence in
+   [MP] B.4, using page directory PD, and waits up to 100 ms for
+   it to come online.  Returns true if successful, false
+   otherwise. */
+static bool
+start_ap (struct cpu *c, uint32_t *pd) 
+{
+  uint32_t *cr3 = ptov (LOADER_AP_BASE + ((char *) &ap_start_cr3 - ap_start));
+  uint32_t *esp = ptov (LOADER_AP_BASE + ((char *) &ap_start_esp - ap_start));
+  int i;
+
+  c->stack = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+  *cr3 = vtop (pd);
+  *esp = (uint32_t) c->stack + PGSIZE;
+
+  if (!lapic_send_init (c->apic_id))
+    return false;
+  timer_msleep (10);
+  for (i = 0; i < 2; i++) 
+    {
+      if (!lapic_send_startup (c->apic_id, LOADER_AP_BASE))
+        return false;
+      timer_udelay (200);
+    }
+
+  for (i = 0; i < 100 && !c->online; i++)
+    timer_msleep (1);
+  return c->online;
+}
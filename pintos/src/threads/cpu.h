@@ -0,0 +1,28 @@
+#ifndef THREADS_CPU_H
+#define THREADS_CPU_H
+
+#include <debug.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Maximum number of CPUs that Pintos keeps track of. */
+#define CPU_MAX 8
+
+/* A CPU. */
+struct cpu 
+  {
+    int id;                     /* Index in the CPU table. */
+    uint8_t apic_id;            /* Local APIC ID. */
+    bool bsp;                   /* Bootstrap processor? */
+    volatile bool online;       /* Up and running? */
+    void *stack;                /* Boot stack page, for APs. */
+  };
+
+void cpu_init (void);
+struct cpu *cpu_current (void);
+int cpu_count (void);
+int cpu_online_count (void);
+
+void cpu_ap_main (void) NO_RETURN;
+
+#endif /* threads/cpu.h */
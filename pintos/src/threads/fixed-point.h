@@ -0,0 +1,61 @@
+#ifndef THREADS_FIXED_POINT_H
+#define THREADS_FIXED_POINT_H
+
+#include <stdint.h>
+
+/* Signed 17.14 fixed-point real numbers, as used by the
+   multi-level feedback queue scheduler.
+
+   A fixed_t holds the real number X as the integer X * FP_ONE,
+   i.e. 17 bits before the binary point (including the sign bit)
+   and 14 bits after it, for a range of about +/-131,071.99.
+   Multiplication and division widen to 64 bits so that the
+   intermediate results cannot overflow. */
+typedef int32_t fixed_t;
+
+#define FP_SHIFT 14                     /* Bits after binary point. */
+#define FP_ONE (1 << FP_SHIFT)          /* 1.0 in fixed point. */
+
+/* Converts integer N to fixed point. */
+static inline fixed_t
+fp_from_int (int n)
+{
+  return n * FP_ONE;
+}
+
+/* Converts X to an integer, rounding toward zero. */
+static inline int
+fp_to_int (fixed_t x)
+{
+  return x / FP_ONE;
+}
+
+/* Converts X to an integer, rounding to nearest. */
+static inline int
+fp_round (fixed_t x)
+{
+  return x >= 0 ? (x + FP_ONE / 2) / FP_ONE : (x - FP_ONE / 2) / FP_ONE;
+}
+
+/* Returns X + N, for integer N. */
+static inline fixed_t
+fp_add_int (fixed_t x, int n)
+{
+  return x + n * FP_ONE;
+}
+
+/* Returns X * Y. */
+static inline fixed_t
+fp_mul (fixed_t x, fixed_t y)
+{
+  return (int64_t) x * y / FP_ONE;
+}
+
+/* Returns X / Y. */
+static inline fixed_t
+fp_div (fixed_t x, fixed_t y)
+{
+  return (int64_t) x * FP_ONE / y;
+}
+
+#endif /* threads/fixed-point.h */
@@ -0,0 +1,206 @@
+#include "threads/fpu.h"
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+
+/* CR0 bits.  See [IA32-v3a] 2.5 "Control Registers". */
+#define CR0_MP 0x00000002       /* Monitor coprocessor. */
+#define CR0_EM 0x00000004       /* (Floating-point) Emulation. */
+#define CR0_TS 0x00000008       /* Task switched. */
+#define CR0_NE 0x00000020       /* Native FPU error reporting. */
+
+/* CR4 bits. */
+#define CR4_OSFXSR 0x00000200   /* FXSAVE, FXRSTOR, and SSE enabled. */
+#define CR4_OSXMMEXCPT 0x00000400 /* #XF for SSE exceptions. */
+
+/* CPUID feature bits, in EDX for leaf 1. */
+#define CPUID_FXSR 0x01000000   /* FXSAVE and FXRSTOR. */
+#define CPUID_SSE 0x02000000    /* SSE. */
+
+/* Size and alignment of a save area.  An FXSAVE image is 512
+   bytes and must be 16-byte aligned.  An FNSAVE image, used if
+   the CPU lacks FXSAVE, is only 108 bytes. */
+#define FPU_AREA_SIZE 512
+#define FPU_AREA_ALIGN 16
+
+/* Does the CPU have FXSAVE and FXRSTOR? */
+static bool have_fxsr;
+
+/* Thread whose state is in the FPU registers, if any. */
+static struct thread *fpu_owner;
+
+/* Save area holding the FPU state a thread starts out with. */
+static uint8_t initial_state[FPU_AREA_SIZE]
+  __attribute__ ((aligned (FPU_AREA_ALIGN)));
+
+/* Number of times the FPU changed owners. */
+static long long fpu_switch_cnt;
+
+static inline uint32_t read_cr0 (void);
+static inline void write_cr0 (uint32_t);
+static void *area (struct thread *);
+static void save (void *);
+static void restore (void *);
+
+/* Enables the FPU and, if the CPU supports them, FXSAVE and SSE,
+   and records the state that threads start out with.  Leaves
+   CR0.TS set, so that the first thread to use the FPU traps. */
+void
+fpu_init (void) 
+{
+  uint32_t eax, ebx, ecx, edx;
+  uint32_t cr0;
+
+  asm volatile ("cpuid"
+                : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+                : "a" (1));
+  have_fxsr = (edx & CPUID_FXSR) != 0;
+  if (have_fxsr)
+    {
+      uint32_t cr4;
+
+      asm volatile ("movl %%cr4, %0" : "=r" (cr4));
+      cr4 |= CR4_OSFXSR;
+      if (edx & CPUID_SSE)
+        cr4 |= CR4_OSXMMEXCPT;
+      asm volatile ("movl %0, %%cr4" : : "r" (cr4));
+    }
+
+  cr0 = read_cr0 ();
+  cr0 &= ~(CR0_EM | CR0_TS);
+  cr0 |= CR0_MP | CR0_NE;
+  write_cr0 (cr0);
+
+  asm volatile ("fninit");
+  save (initial_state);
+
+  write_cr0 (cr0 | CR0_TS);
+}
+
+/* Called by the scheduler when thread T starts running: lets T
+   use the FPU directly if it owns it, and otherwise sets CR0.TS
+   so that its first FPU instruction traps.  Interrupts must be
+   off. */
+void
+fpu_switch (struct thread *t) 
+{
+  uint32_t cr0 = read_cr0 ();
+  uint32_t new_cr0 = t == fpu_owner ? cr0 & ~CR0_TS : cr0 | CR0_TS;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (new_cr0 != cr0)
+    write_cr0 (new_cr0);
+}
+
+/* Handles #NM: makes the running thread the owner of the FPU,
+   saving the previous owner's state and loading the running
+   thread's, allocating a save area for it first if it has
+   none.  Returns true if successful, false if memory for the
+   save area was not available.
+
+   malloc() may sleep on its lock, so this must be called from
+   an internal interrupt handler registered with INTR_ON, never
+   from an external interrupt. */
+bool
+fpu_claim (void) 
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (!intr_context ());
+  ASSERT (intr_get_level () == INTR_ON);
+
+  if (cur->fpu == NULL)
+    {
+      cur->fpu = malloc (FPU_AREA_SIZE + FPU_AREA_ALIGN - 1);
+      if (cur->fpu == NULL)
+        return false;
+      memcpy (area (cur), initial_state, FPU_AREA_SIZE);
+    }
+
+  old_level = intr_disable ();
+  asm volatile ("clts");
+  if (fpu_owner != cur)
+    {
+      if (fpu_owner != NULL)
+        save (area (fpu_owner));
+      restore (area (cur));
+      fpu_owner = cur;
+      fpu_switch_cnt++;
+    }
+  intr_set_level (old_level);
+  return true;
+}
+
+/* Frees T's save area, if any.  Called when T exits. */
+void
+fpu_release (struct thread *t) 
+{
+  enum intr_level old_level = intr_disable ();
+  if (fpu_owner == t)
+    fpu_owner = NULL;
+  intr_set_level (old_level);
+
+  free (t->fpu);
+  t->fpu = NULL;
+}
+
+/* Prints FPU statistics. */
+void
+fpu_print_stats (void) 
+{
+  printf ("FPU: %lld owner changes\n", fpu_switch_cnt);
+}
+
+/* Returns CR0. */
+static inline uint32_t
+read_cr0 (void) 
+{
+  uint32_t cr0;
+  asm volatile ("movl %%cr0, %0" : "=r" (cr0));
+  return cr0;
+}
+
+/* Sets CR0 to CR0. */
+static inline void
+write_cr0 (uint32_t cr0) 
+{
+  asm volatile ("movl %0, %%cr0" : : "r" (cr0));
+}
+
+/* Returns T's save area, which must have been allocated. */
+static void *
+area (struct thread *t) 
+{
+  ASSERT (t->fpu != NULL);
+  return (void *) ROUND_UP ((uintptr_t) t->fpu, FPU_AREA_ALIGN);
+}
+
+/* Saves the FPU state into save area AREA.  CR0.TS must be
+   clear. */
+static void
+save (void *area) 
+{
+  if (have_fxsr)
+    asm volatile ("fxsave %0" : "=m" (*(uint8_t (*)[FPU_AREA_SIZE]) area));
+  else
+    asm volatile ("fnsave %0; fwait"
+                  : "=m" (*(uint8_t (*)[FPU_AREA_SIZE]) area));
+}
+
+/* Loads the FPU state from save area AREA.  CR0.TS must be
+   clear. */
+static void
+restore (void *area) 
+{
+  if (have_fxsr)
+    asm volatile ("fxrstor %0" : : "m" (*(uint8_t (*)[FPU_AREA_SIZE]) area));
+  else
+    asm volatile ("frstor %0" : : "m" (*(uint8_t (*)[FPU_AREA_SIZE]) area));
+}
@@ -0,0 +1,29 @@
+#ifndef THREADS_FPU_H
+#define THREADS_FPU_H
+
+#include <stdbool.h>
+
+/* Lazy FPU context switching.
+
+   The x87 FPU and SSE registers are not saved and restored on
+   every context switch.  Instead, the FPU belongs to at most one
+   thread at a time, its "owner", whose state is in the
+   registers.  Switching to any other thread sets CR0.TS, so that
+   the thread's first FPU or SSE instruction raises #NM (Device
+   Not Available).  The #NM handler then saves the owner's state
+   into the owner's save area, loads the current thread's, and
+   makes the current thread the owner.
+
+   A thread gets a save area, from malloc(), only the first time
+   it uses the FPU, so threads that never use it pay nothing but
+   a CR0 write when the owner is switched away from. */
+
+struct thread;
+
+void fpu_init (void);
+void fpu_switch (struct thread *);
+bool fpu_claim (void);
+void fpu_release (struct thread *);
+void fpu_print_stats (void);
+
+#endif /* threads/fpu.h */
@@ -0,0 +1,116 @@
+#include "threads/futex.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <stdint.h>
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Number of wait queue buckets.  Futexes whose keys hash to the
+   same bucket share its lock and list. */
+#define FUTEX_BUCKETS 64
+
+/* A bucket of waiters. */
+struct futex_bucket
+  {
+    struct lock lock;           /* Protects WAITERS and the keys' values. */
+    struct list waiters;        /* List of struct futex_waiter. */
+  };
+
+/* A thread waiting on a futex.  Lives on the waiter's stack. */
+struct futex_waiter
+  {
+    struct list_elem elem;      /* Element in futex_bucket's WAITERS. */
+    int *key;                   /* Kernel address waited on. */
+    struct thread *thread;      /* Waiting thread. */
+    struct semaphore sema;      /* Upped when woken. */
+  };
+
+static struct futex_bucket buckets[FUTEX_BUCKETS];
+
+/* Returns the bucket for KEY. */
+static struct futex_bucket *
+bucket_of (const int *key)
+{
+  return &buckets[hash_int ((uintptr_t) key / sizeof *key) % FUTEX_BUCKETS];
+}
+
+/* Initializes the futex buckets. */
+void
+futex_init (void)
+{
+  size_t i;
+
+  for (i = 0; i < FUTEX_BUCKETS; i++)
+    {
+      lock_init (&buckets[i].lock);
+      list_init (&buckets[i].waiters);
+    }
+}
+
+/* If the int at KADDR still holds EXPECTED, sleeps until
+   futex_wakeup() is called on KADDR and returns true.
+   Otherwise returns false at once.
+
+   The check and the enqueue happen under the bucket lock, which
+   futex_wakeup() also takes, so a wakeup issued after the int
+   changes can never be missed. */
+bool
+futex_sleep (int *kaddr, int expected)
+{
+  struct futex_bucket *b = bucket_of (kaddr);
+  struct futex_waiter w;
+
+  ASSERT (kaddr != NULL);
+
+  lock_acquire (&b->lock);
+  if (*(volatile int *) kaddr != expected)
+    {
+      lock_release (&b->lock);
+      return false;
+    }
+  w.key = kaddr;
+  w.thread = thread_current ();
+  sema_init (&w.sema, 0);
+  list_push_back (&b->waiters, &w.elem);
+  lock_release (&b->lock);
+
+  sema_down (&w.sema);
+  return true;
+}
+
+/* Wakes up to CNT threads sleeping on KADDR, highest priority
+   first, and returns the number woken. */
+int
+futex_wakeup (int *kaddr, int cnt)
+{
+  struct futex_bucket *b = bucket_of (kaddr);
+  int woken = 0;
+
+  ASSERT (kaddr != NULL);
+
+  lock_acquire (&b->lock);
+  while (woken < cnt)
+    {
+      struct futex_waiter *best = NULL;
+      struct list_elem *e;
+
+      for (e = list_begin (&b->waiters); e != list_end (&b->waiters);
+           e = list_next (e))
+        {
+          struct futex_waiter *w = list_entry (e, struct futex_waiter, elem);
+          if (w->key == kaddr
+              && (best == NULL || w->thread->priority > best->thread->priority))
+            best = w;
+        }
+      if (best == NULL)
+        break;
+
+      list_remove (&best->elem);
+      sema_up (&best->sema);
+      woken++;
+    }
+  lock_release (&b->lock);
+
+  return woken;
+}
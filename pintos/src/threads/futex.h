@@ -0,0 +1,19 @@
+#ifndef THREADS_FUTEX_H
+#define THREADS_FUTEX_H
+
+#include <stdbool.h>
+
+/* Futexes: wait queues keyed by the address of an int.
+
+   The key is the kernel virtual address of the int.  For a
+   futex in user memory, the system calls pass the address of
+   the int within its physical frame, not the user address that
+   refers to it, so two processes that map the same frame at
+   different user addresses share a queue.  Kernel threads may
+   also use futexes on kernel ints directly. */
+
+void futex_init (void);
+bool futex_sleep (int *kaddr, int expected);
+int futex_wakeup (int *kaddr, int cnt);
+
+#endif /* threads/futex.h */
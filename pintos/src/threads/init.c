@@ -15,18 +15,27 @@
 #include "devices/timer.h"
 #include "devices/vga.h"
 #include "devices/rtc.h"
+#include "threads/cpu.h"
+#include "threads/fpu.h"
+#include "threads/futex.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
+#include "threads/latency.h"
+#include "threads/lockstat.h"
 #include "threads/loader.h"
 #include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
+#include "threads/softirq.h"
 #include "threads/thread.h"
+#include "threads/task.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
 #include "userprog/gdt.h"
 #include "userprog/syscall.h"
+#include "userprog/sysstat.h"
 #include "userprog/tss.h"
 #else
 #include "tests/threads/tests.h"
@@ -54,6 +63,9 @@ static const char *swap_bdev_name;
 #endif
 #endif /* FILESYS */
 
+/* -smp: Start the application processors? */
+static bool start_aps;
+
 /* -ul: Maximum number of pages to put into palloc's user pool. */
 static size_t user_page_limit = SIZE_MAX;
 
@@ -63,6 +75,7 @@ static void paging_init (void);
 static char **read_command_line (void);
 static char **parse_options (char **argv);
 static void run_actions (char **argv);
+static void print_lockstat (char **argv);
 static void usage (void);
 
 #ifdef FILESYS
@@ -107,9 +120,11 @@ main (void)
 
   /* Initialize interrupt handlers. */
   intr_init ();
+  fpu_init ();
   timer_init ();
   kbd_init ();
   input_init ();
+  futex_init ();
 #ifdef USERPROG
   exception_init ();
   syscall_init ();
@@ -117,8 +132,14 @@ main (void)
 
   /* Start thread scheduler and enable interrupts. */
   thread_start ();
+  softirq_init ();
+  workqueue_init ();
+  task_pool_init ();
   serial_init_queue ();
   timer_calibrate ();
+  latency_calibrate ();
+  if (start_aps)
+    cpu_init ();
 
 #ifdef FILESYS
   /* Initialize file system. */
@@ -256,14 +277,29 @@ parse_options (char **argv)
         random_init (atoi (value));
       else if (!strcmp (name, "-mlfqs"))
         thread_mlfqs = true;
+      else if (!strcmp (name, "-stride"))
+        thread_stride = true;
+      else if (!strcmp (name, "-smp"))
+        start_aps = true;
+      else if (!strcmp (name, "-lockstat"))
+        lockstat_enabled = true;
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
+      else if (!strcmp (name, "-sysstat"))
+        sysstat_enabled = true;
+      else if (!strcmp (name, "-strace"))
+        syscall_trace = true;
+      else if (!strcmp (name, "-user-rt"))
+        syscall_user_rt = true;
 #endif
       else
         PANIC ("unknown option `%s' (use -h for help)", name);
     }
 
+  if (thread_mlfqs && thread_stride)
+    PANIC ("options -mlfqs and -stride are mutually exclusive");
+
   /* Initialize the random number generator based on the system
      time.  This has no effect if an "-rs" option was specified.
 
@@ -292,6 +328,13 @@ run_task (char **argv)
   printf ("Execution of '%s' complete.\n", task);
 }
 
+/* Prints lock contention statistics. */
+static void
+print_lockstat (char **argv UNUSED)
+{
+  lockstat_print_stats ();
+}
+
 /* Executes all of the actions specified in ARGV[]
    up to the null pointer sentinel. */
 static void
@@ -309,6 +352,7 @@ run_actions (char **argv)
   static const struct action actions[] = 
     {
       {"run", 2, run_task},
+      {"lockstat", 1, print_lockstat},
 #ifdef FILESYS
       {"ls", 1, fsutil_ls},
       {"cat", 2, fsutil_cat},
@@ -357,6 +401,7 @@ usage (void)
 #else
           "  run TEST           Run TEST.\n"
 #endif
+          "  lockstat           Print lock statistics (needs -lockstat).\n"
 #ifdef FILESYS
           "  ls                 List files in the root directory.\n"
           "  cat FILE           Print FILE to the console.\n"
@@ -379,8 +424,14 @@ usage (void)
 #endif
           "  -rs=SEED           Set random number seed to SEED.\n"
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+          "  -stride            Use stride (proportional-share) scheduler.\n"
+          "  -smp               Start the other CPUs listed by the BIOS.\n"
+          "  -lockstat          Keep lock contention statistics.\n"
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
+          "  -sysstat           Count system calls and their latencies.\n"
+          "  -strace            Print each system call as it is made.\n"
+          "  -user-rt           Let user processes use SCHED_FIFO and SCHED_RR.\n"
 #endif
           );
   shutdown_power_off ();
@@ -6,6 +6,7 @@
 #include "threads/flags.h"
 #include "threads/intr-stubs.h"
 #include "threads/io.h"
+#include "threads/softirq.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
 #include "devices/timer.h"
@@ -43,8 +44,14 @@ static unsigned int unexpected_cnt[INTR_CNT];
    pre-empted.  Handlers for external interrupts also may not
    sleep, although they may invoke intr_yield_on_return() to
    request that a new process be scheduled just before the
-   interrupt returns. */
+   interrupt returns.
+
+   Softirqs (see softirq.h) run with interrupts on, so external
+   interrupts may nest inside them, but they count as interrupt
+   context too.  A yield requested by an interrupt that arrives
+   while softirqs run is put off until they are done. */
 static bool in_external_intr;   /* Are we processing an external interrupt? */
+static bool in_softirq;         /* Are we running softirqs? */
 static bool yield_on_return;    /* Should we yield on interrupt return? */
 
 /* Programmable Interrupt Controller helpers. */
@@ -88,7 +95,7 @@ enum intr_level
 intr_enable (void) 
 {
   enum intr_level old_level = intr_get_level ();
-  ASSERT (!intr_context ());
+  ASSERT (!in_external_intr);
 
   /* Enable interrupts by setting the interrupt flag.
 
@@ -117,7 +124,6 @@ intr_disable (void)
 void
 intr_init (void)
 {
-  uint64_t idtr_operand;
   int i;
 
   /* Initialize interrupt controller. */
@@ -126,12 +132,7 @@ intr_init (void)
   /* Initialize IDT. */
   for (i = 0; i < INTR_CNT; i++)
     idt[i] = make_intr_gate (intr_stubs[i], 0);
-
-  /* Load IDT register.
-     See [IA32-v2a] "LIDT" and [IA32-v3a] 5.10 "Interrupt
-     Descriptor Table (IDT)". */
-  idtr_operand = make_idtr_operand (sizeof idt - 1, idt);
-  asm volatile ("lidt %0" : : "m" (idtr_operand));
+  intr_load_idt ();
 
   /* Initialize intr_names. */
   for (i = 0; i < INTR_CNT; i++)
@@ -157,6 +158,18 @@ intr_init (void)
   intr_names[19] = "#XF SIMD Floating-Point Exception";
 }
 
+/* Loads the IDT register of the running CPU with the IDT.  The
+   bootstrap processor does this in intr_init(); application
+   processors call it as they start up.
+   See [IA32-v2a] "LIDT" and [IA32-v3a] 5.10 "Interrupt
+   Descriptor Table (IDT)". */
+void
+intr_load_idt (void) 
+{
+  uint64_t idtr_operand = make_idtr_operand (sizeof idt - 1, idt);
+  asm volatile ("lidt %0" : : "m" (idtr_operand));
+}
+
 /* Registers interrupt VEC_NO to invoke HANDLER with descriptor
    privilege level DPL.  Names the interrupt NAME for debugging
    purposes.  The interrupt handler will be invoked with
@@ -206,18 +219,45 @@ intr_register_int (uint8_t vec_no, int dpl, enum intr_level level,
   register_handler (vec_no, dpl, level, handler, name);
 }
 
-/* Returns true during processing of an external interrupt
-   and false at all other times. */
+/* Returns true during processing of an external interrupt or
+   of softirqs and false at all other times. */
 bool
 intr_context (void) 
 {
-  return in_external_intr;
+  return in_external_intr || in_softirq;
 }
 
-/* During processing of an external interrupt, directs the
-   interrupt handler to yield to a new process just before
-   returning from the interrupt.  May not be called at any other
-   time. */
+/* Marks the start of a round of softirqs run outside an
+   interrupt handler, by ksoftirqd.  Interrupts must be off. */
+void
+intr_softirq_enter (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (!intr_context ());
+
+  in_softirq = true;
+  yield_on_return = false;
+}
+
+/* Marks the end of a round of softirqs started with
+   intr_softirq_enter().  Returns true if the softirqs, or an
+   interrupt that arrived while they ran, asked to yield, in
+   which case the caller should yield.  Interrupts must be
+   off. */
+bool
+intr_softirq_exit (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (in_softirq && !in_external_intr);
+
+  in_softirq = false;
+  return yield_on_return;
+}
+
+/* During processing of an external interrupt or of softirqs,
+   directs the interrupt handler to yield to a new process just
+   before returning from the interrupt.  May not be called at any
+   other time. */
 void
 intr_yield_on_return (void) 
 {
@@ -355,10 +395,17 @@ intr_handler (struct intr_frame *frame)
   if (external) 
     {
       ASSERT (intr_get_level () == INTR_OFF);
-      ASSERT (!intr_context ());
+      ASSERT (!in_external_intr);
 
+      /* If we interrupted softirqs, a yield they requested is
+         still to be done when they finish. */
       in_external_intr = true;
-      yield_on_return = false;
+      if (!in_softirq)
+        yield_on_return = false;
+
+      /* If the CPU was idle with the timer in one-shot mode,
+         catch up on the ticks we slept through. */
+      timer_nohz_exit ();
     }
 
   /* Invoke the interrupt's handler. */
@@ -383,8 +430,20 @@ intr_handler (struct intr_frame *frame)
       in_external_intr = false;
       pic_end_of_interrupt (frame->vec_no); 
 
-      if (yield_on_return) 
-        thread_yield (); 
+      /* Unless we interrupted softirqs, which will then carry on
+         where they left off, run pending softirqs and then yield
+         if asked to. */
+      if (!in_softirq)
+        {
+          if (softirq_pending ())
+            {
+              in_softirq = true;
+              softirq_run ();
+              in_softirq = false;
+            }
+          if (yield_on_return) 
+            thread_yield_preempted (); 
+        }
     }
 }
 
@@ -0,0 +1,232 @@
+#include "threads/latency.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* One histogram per priority level, including PRI_DL.  Samples
+   are filed under the priority the thread has when it starts
+   running, so donated priority counts. */
+static struct latency_hist pri_hist[PRI_DL + 1];
+
+/* A worst-case sample. */
+struct latency_sample
+  {
+    uint64_t cycles;            /* Latency. */
+    int64_t when;               /* Timer tick when it ended. */
+    tid_t tid;                  /* Thread that waited. */
+    int priority;               /* Its priority. */
+    char name[16];              /* Its name. */
+    tid_t culprit;              /* Thread that ran before it. */
+    char culprit_name[16];      /* That thread's name. */
+  };
+
+/* The worst samples seen so far, worst first.  Unused entries
+   have cycles == 0. */
+#define WORST_CNT 8
+static struct latency_sample worst[WORST_CNT];
+
+/* Time-stamp counter cycles per microsecond, or 0 if unknown. */
+static uint64_t cycles_per_us;
+
+static int bucket (uint64_t cycles);
+static void hist_add (struct latency_hist *, uint64_t cycles,
+                      const struct thread *culprit);
+static void hist_print (const char *label, const struct latency_hist *);
+static void print_thread_hist (struct thread *, void *aux);
+static void print_cycles (uint64_t cycles);
+
+/* Measures the speed of the time-stamp counter against the
+   timer, so that latencies can be reported in microseconds as
+   well as cycles.  Takes one timer tick.  Interrupts must be
+   on. */
+void
+latency_calibrate (void) 
+{
+  int64_t start;
+  uint64_t tsc;
+
+  ASSERT (intr_get_level () == INTR_ON);
+
+  /* Wait for a timer tick to start. */
+  start = timer_ticks ();
+  while (timer_ticks () == start)
+    barrier ();
+
+  /* Count cycles until the next one. */
+  tsc = rdtsc ();
+  start = timer_ticks ();
+  while (timer_ticks () == start)
+    barrier ();
+  tsc = rdtsc () - tsc;
+
+  cycles_per_us = tsc * TIMER_FREQ / 1000000;
+  printf ("Latency tracer: %"PRIu64" cycles per microsecond.\n",
+          cycles_per_us);
+}
+
+/* Returns the number of time-stamp counter cycles per
+   microsecond, or 0 if latency_calibrate() has not run yet. */
+uint64_t
+latency_cycles_per_us (void) 
+{
+  return cycles_per_us;
+}
+
+/* Records that T is becoming ready to run after being blocked.
+   Called by thread_unblock() with interrupts off. */
+void
+latency_wakeup (struct thread *t) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  t->latency.ready_tsc = rdtsc ();
+}
+
+/* Records that CUR has started running, after PREV, which is
+   null if CUR was already running.  If CUR was woken up, adds
+   its wakeup latency to the histograms.  Called by
+   thread_schedule_tail() with interrupts off. */
+void
+latency_run (struct thread *cur, struct thread *prev) 
+{
+  struct thread *culprit = prev != NULL ? prev : cur;
+  uint64_t cycles;
+  int i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (cur->latency.ready_tsc == 0)
+    return;
+  cycles = rdtsc () - cur->latency.ready_tsc;
+  cur->latency.ready_tsc = 0;
+
+  hist_add (&cur->latency.hist, cycles, culprit);
+  hist_add (&pri_hist[cur->priority], cycles, culprit);
+
+  /* Insert into the worst samples, if it belongs there. */
+  for (i = 0; i < WORST_CNT; i++)
+    if (cycles > worst[i].cycles)
+      {
+        struct latency_sample *s = &worst[i];
+
+        memmove (s + 1, s, (WORST_CNT - i - 1) * sizeof *s);
+        s->cycles = cycles;
+        s->when = timer_ticks ();
+        s->tid = cur->tid;
+        s->priority = cur->priority;
+        strlcpy (s->name, cur->name, sizeof s->name);
+        s->culprit = culprit->tid;
+        strlcpy (s->culprit_name, culprit->name, sizeof s->culprit_name);
+        break;
+      }
+}
+
+/* Prints the latency histograms of each priority level and each
+   live thread that has any samples, and the worst samples. */
+void
+latency_print_stats (void) 
+{
+  enum intr_level old_level = intr_disable ();
+  char label[32];
+  int i;
+
+  printf ("Latency: bucket K counts wakeups that waited 2**K cycles"
+          " or more\n");
+  for (i = 0; i <= PRI_DL; i++)
+    if (pri_hist[i].samples > 0)
+      {
+        snprintf (label, sizeof label, "pri %d", i);
+        hist_print (label, &pri_hist[i]);
+      }
+  thread_foreach (print_thread_hist, label);
+
+  for (i = 0; i < WORST_CNT && worst[i].cycles > 0; i++)
+    {
+      const struct latency_sample *s = &worst[i];
+
+      printf ("Latency: worst #%d: tid %d (%s) at pri %d waited ",
+              i + 1, s->tid, s->name, s->priority);
+      print_cycles (s->cycles);
+      printf (" at tick %"PRId64", after tid %d (%s)\n",
+              s->when, s->culprit, s->culprit_name);
+    }
+  intr_set_level (old_level);
+}
+
+/* Returns the histogram bucket for CYCLES. */
+static int
+bucket (uint64_t cycles) 
+{
+  int k = 0;
+
+  while (cycles > 1 && k < LATENCY_BUCKETS - 1)
+    {
+      cycles >>= 1;
+      k++;
+    }
+  return k;
+}
+
+/* Adds a sample of CYCLES to H.  CULPRIT is the thread that ran
+   just before the sample ended. */
+static void
+hist_add (struct latency_hist *h, uint64_t cycles,
+          const struct thread *culprit) 
+{
+  h->count[bucket (cycles)]++;
+  h->samples++;
+  if (cycles > h->max)
+    {
+      h->max = cycles;
+      h->max_culprit = culprit->tid;
+    }
+}
+
+/* Prints H, labeled with LABEL, on one line.  Only the range of
+   buckets that hold samples is printed. */
+static void
+hist_print (const char *label, const struct latency_hist *h) 
+{
+  int lo, hi, k;
+
+  for (lo = 0; h->count[lo] == 0; lo++)
+    continue;
+  for (hi = LATENCY_BUCKETS - 1; h->count[hi] == 0; hi--)
+    continue;
+
+  printf ("Latency: %-20s %6"PRIu32" wakeups, max ", label, h->samples);
+  print_cycles (h->max);
+  printf (" after tid %d:", h->max_culprit);
+  for (k = lo; k <= hi; k++)
+    printf (" %d:%"PRIu32, k, h->count[k]);
+  printf ("\n");
+}
+
+/* thread_foreach() callback that prints T's histogram, if it
+   has any samples.  AUX is a buffer for the label. */
+static void
+print_thread_hist (struct thread *t, void *aux) 
+{
+  char *label = aux;
+
+  if (t->latency.hist.samples > 0)
+    {
+      snprintf (label, 32, "tid %d (%s)", t->tid, t->name);
+      hist_print (label, &t->latency.hist);
+    }
+}
+
+/* Prints CYCLES, and the equivalent in microseconds if the
+   time-stamp counter has been calibrated. */
+static void
+print_cycles (uint64_t cycles) 
+{
+  printf ("%"PRIu64" cycles", cycles);
+  if (cycles_per_us != 0)
+    printf (" (%"PRIu64" us)", cycles / cycles_per_us);
+}
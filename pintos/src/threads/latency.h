@@ -0,0 +1,54 @@
+#ifndef THREADS_LATENCY_H
+#define THREADS_LATENCY_H
+
+#include <stdint.h>
+
+/* Wakeup latency tracer.
+
+   Measures, with the CPU's time-stamp counter, how long each
+   thread waits between becoming ready in thread_unblock() and
+   actually starting to run in thread_schedule_tail().  Samples
+   are accumulated in log2 histograms, one per priority level
+   and one per thread, and the worst samples are kept along with
+   the thread that was running just before the woken thread got
+   the CPU. */
+
+/* Number of histogram buckets.  Bucket K counts latencies of
+   2**K to 2**(K+1) - 1 cycles, except that bucket 0 also counts
+   0 cycles and the last bucket counts everything longer. */
+#define LATENCY_BUCKETS 32
+
+/* A latency histogram. */
+struct latency_hist
+  {
+    uint32_t count[LATENCY_BUCKETS]; /* Samples per bucket. */
+    uint32_t samples;           /* Total number of samples. */
+    uint64_t max;               /* Worst latency, in cycles. */
+    int max_culprit;            /* Thread that ran before the worst. */
+  };
+
+/* Per-thread tracer state, embedded in struct thread. */
+struct latency_thread
+  {
+    uint64_t ready_tsc;         /* When woken up, or 0 if not. */
+    struct latency_hist hist;   /* Wakeup latencies so far. */
+  };
+
+struct thread;
+
+/* Returns the current value of the time-stamp counter. */
+static inline uint64_t
+rdtsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+void latency_calibrate (void);
+uint64_t latency_cycles_per_us (void);
+void latency_wakeup (struct thread *);
+void latency_run (struct thread *cur, struct thread *prev);
+void latency_print_stats (void);
+
+#endif /* threads/latency.h */
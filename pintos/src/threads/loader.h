@@ -8,6 +8,11 @@
 /* Physical address of kernel base. */
 #define LOADER_KERN_BASE 0x20000       /* 128 kB. */
 
+/* Physical address to which the application processor startup
+   code in ap-start.S is copied.  Must be page-aligned, below
+   1 MB, and clear of the loader and the kernel. */
+#define LOADER_AP_BASE 0x7000          /* 28 kB. */
+
 /* Kernel virtual address at which all physical memory is mapped.
    Must be aligned on a 4 MB boundary. */
 #define LOADER_PHYS_BASE 0xc0000000     /* 3 GB. */
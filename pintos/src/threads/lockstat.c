@@ -0,0 +1,193 @@
+#include "threads/lockstat.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/latency.h"
+#include "threads/thread.h"
+
+/* If true, gather statistics. */
+bool lockstat_enabled;
+
+/* Lock classes, in order of creation. */
+#define LOCKSTAT_CLASSES 96
+static struct lockstat_class classes[LOCKSTAT_CLASSES];
+static size_t class_cnt;
+
+/* Number of locks left out because CLASSES was full. */
+static unsigned overflow_cnt;
+
+static void add_waiter (struct lockstat_class *, uint64_t wait);
+static void print_class (const struct lockstat_class *);
+
+/* Returns the class named NAME, creating it if necessary, or a
+   null pointer if statistics are not being gathered or there
+   is no room for another class.  NAME must stay valid for as
+   long as the kernel runs; lock_init() passes a string
+   literal. */
+struct lockstat_class *
+lockstat_class (const char *name) 
+{
+  struct lockstat_class *c = NULL;
+  enum intr_level old_level;
+  size_t i;
+
+  ASSERT (name != NULL);
+
+  if (!lockstat_enabled)
+    return NULL;
+
+  old_level = intr_disable ();
+  for (i = 0; i < class_cnt; i++)
+    if (classes[i].name == name || !strcmp (classes[i].name, name))
+      {
+        c = &classes[i];
+        break;
+      }
+  if (c == NULL)
+    {
+      if (class_cnt < LOCKSTAT_CLASSES)
+        {
+          c = &classes[class_cnt++];
+          c->name = name;
+        }
+      else
+        overflow_cnt++;
+    }
+  intr_set_level (old_level);
+
+  return c;
+}
+
+/* Records that the current thread acquired a lock or semaphore
+   in class C.  WAIT_START is the time-stamp counter value when
+   it started waiting, or 0 if it did not have to wait. */
+void
+lockstat_acquired (struct lockstat_class *c, uint64_t wait_start) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  c->acquired++;
+  if (wait_start != 0)
+    {
+      uint64_t wait = rdtsc () - wait_start;
+
+      c->contended++;
+      c->wait_total += wait;
+      if (wait > c->wait_max)
+        c->wait_max = wait;
+      add_waiter (c, wait);
+    }
+  intr_set_level (old_level);
+}
+
+/* Records that the current thread released a lock in class C
+   that it acquired when the time-stamp counter read
+   HOLD_START. */
+void
+lockstat_released (struct lockstat_class *c, uint64_t hold_start) 
+{
+  uint64_t hold = rdtsc () - hold_start;
+  enum intr_level old_level = intr_disable ();
+
+  c->hold_total += hold;
+  if (hold > c->hold_max)
+    c->hold_max = hold;
+  intr_set_level (old_level);
+}
+
+/* Prints the statistics of every class that has been acquired,
+   most total wait first. */
+void
+lockstat_print_stats (void) 
+{
+  static const struct lockstat_class *sorted[LOCKSTAT_CLASSES];
+  enum intr_level old_level;
+  size_t cnt, i;
+
+  if (!lockstat_enabled)
+    return;
+
+  /* Insertion sort by total wait.  Interrupts stay off so that
+     the numbers printed are consistent. */
+  old_level = intr_disable ();
+  cnt = 0;
+  for (i = 0; i < class_cnt; i++)
+    if (classes[i].acquired > 0)
+      {
+        const struct lockstat_class *c = &classes[i];
+        size_t j;
+
+        for (j = cnt++; j > 0 && sorted[j - 1]->wait_total < c->wait_total;
+             j--)
+          sorted[j] = sorted[j - 1];
+        sorted[j] = c;
+      }
+
+  printf ("Lockstat: %"PRIu64" cycles per us; times in cycles\n",
+          latency_cycles_per_us ());
+  printf ("Lockstat: %-28s %8s %8s %12s %10s %12s %10s\n", "class",
+          "acquired", "waited", "wait-total", "wait-max", "hold-total",
+          "hold-max");
+  for (i = 0; i < cnt; i++)
+    print_class (sorted[i]);
+  if (overflow_cnt > 0)
+    printf ("Lockstat: %u locks not tracked, too many classes\n",
+            overflow_cnt);
+  intr_set_level (old_level);
+}
+
+/* Adds WAIT cycles waited by the current thread to C's top
+   waiters. */
+static void
+add_waiter (struct lockstat_class *c, uint64_t wait) 
+{
+  struct thread *cur = thread_current ();
+  struct lockstat_waiter *w, *min = NULL;
+
+  for (w = c->top; w < c->top + LOCKSTAT_TOP_WAITERS; w++)
+    {
+      if (w->tid == cur->tid)
+        break;
+      if (min == NULL || w->wait_total < min->wait_total)
+        min = w;
+    }
+
+  if (w == c->top + LOCKSTAT_TOP_WAITERS)
+    {
+      /* Not yet a top waiter.  Replace the least one, if this
+         wait alone beats it. */
+      if (min->tid != 0 && min->wait_total >= wait)
+        return;
+      w = min;
+      w->tid = cur->tid;
+      strlcpy (w->name, cur->name, sizeof w->name);
+      w->waits = 0;
+      w->wait_total = 0;
+    }
+  w->waits++;
+  w->wait_total += wait;
+}
+
+/* Prints C and its top waiters. */
+static void
+print_class (const struct lockstat_class *c) 
+{
+  const char *name = c->name;
+  const struct lockstat_waiter *w;
+
+  /* Callsite names start with the build directory's path back
+     to the source tree. */
+  while (!memcmp (name, "../", 3))
+    name += 3;
+
+  printf ("Lockstat: %-28s %8"PRIu32" %8"PRIu32" %12"PRIu64" %10"PRIu64
+          " %12"PRIu64" %10"PRIu64"\n", name, c->acquired, c->contended,
+          c->wait_total, c->wait_max, c->hold_total, c->hold_max);
+  for (w = c->top; w < c->top + LOCKSTAT_TOP_WAITERS; w++)
+    if (w->tid != 0)
+      printf ("Lockstat:   waiter tid %d (%s): %"PRIu32" waits, "
+              "%"PRIu64" cycles\n", w->tid, w->name, w->waits,
+              w->wait_total);
+}
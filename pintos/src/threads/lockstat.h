@@ -0,0 +1,54 @@
+#ifndef THREADS_LOCKSTAT_H
+#define THREADS_LOCKSTAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Lock contention profiler.
+
+   Each lock belongs to a class, named after the place where
+   lock_init() was called or given to lock_init_named().  All
+   the locks in a class share its statistics, so that, say, the
+   locks of all the open inodes show up as one line.  A
+   semaphore belongs to a class only if it is given one with
+   sema_set_name().
+
+   Statistics are kept only if the kernel is started with the
+   -lockstat option; otherwise locks have no class and cost
+   nothing extra.  Times are measured with the time-stamp
+   counter. */
+
+/* Number of threads with the most total wait kept per class. */
+#define LOCKSTAT_TOP_WAITERS 4
+
+/* A thread that waited for a lock class. */
+struct lockstat_waiter
+  {
+    int tid;                    /* Thread identifier, 0 if unused. */
+    char name[16];              /* Thread name. */
+    uint32_t waits;             /* Number of times it waited. */
+    uint64_t wait_total;        /* Total cycles waited. */
+  };
+
+/* Statistics for a lock class. */
+struct lockstat_class
+  {
+    const char *name;           /* Class name. */
+    uint32_t acquired;          /* Number of acquisitions. */
+    uint32_t contended;         /* Number that had to wait. */
+    uint64_t wait_total;        /* Total cycles spent waiting. */
+    uint64_t wait_max;          /* Longest wait, in cycles. */
+    uint64_t hold_total;        /* Total cycles held (locks only). */
+    uint64_t hold_max;          /* Longest hold, in cycles. */
+    struct lockstat_waiter top[LOCKSTAT_TOP_WAITERS];
+  };
+
+/* If true, gather statistics.  Set by the -lockstat option. */
+extern bool lockstat_enabled;
+
+struct lockstat_class *lockstat_class (const char *name);
+void lockstat_acquired (struct lockstat_class *, uint64_t wait_start);
+void lockstat_released (struct lockstat_class *, uint64_t hold_start);
+void lockstat_print_stats (void);
+
+#endif /* threads/lockstat.h */
@@ -0,0 +1,173 @@
+#include "threads/softirq.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Maximum number of rounds of softirqs run on interrupt return
+   before the rest is handed to ksoftirqd. */
+#define MAX_ROUNDS 10
+
+/* Registered handlers. */
+static softirq_func *handlers[SOFTIRQ_CNT];
+static const char *names[SOFTIRQ_CNT];
+
+/* Bit N is set if softirq N is pending.  Protected by disabling
+   interrupts. */
+static unsigned pending;
+
+/* Statistics. */
+static long long run_cnt[SOFTIRQ_CNT];  /* # of times each has run. */
+static long long deferred_cnt;          /* # of times left to ksoftirqd. */
+
+/* The ksoftirqd thread, and a semaphore to wake it. */
+static struct thread *ksoftirqd;
+static struct semaphore ksoftirqd_sema;
+
+static thread_func ksoftirqd_thread NO_RETURN;
+static void run_round (void);
+static void wake_ksoftirqd (void);
+
+/* Starts the ksoftirqd thread.  Softirqs may be registered and
+   raised before this is called, but until then they run only on
+   interrupt return. */
+void
+softirq_init (void) 
+{
+  tid_t tid;
+
+  sema_init (&ksoftirqd_sema, 0);
+  tid = thread_create ("ksoftirqd", PRI_DEFAULT, ksoftirqd_thread, NULL);
+  if (tid == TID_ERROR)
+    PANIC ("could not create ksoftirqd");
+}
+
+/* Registers FUNC to run for softirq NR, which is named NAME for
+   debugging purposes. */
+void
+softirq_register (enum softirq nr, softirq_func *func, const char *name) 
+{
+  ASSERT (nr < SOFTIRQ_CNT);
+  ASSERT (handlers[nr] == NULL);
+
+  handlers[nr] = func;
+  names[nr] = name;
+}
+
+/* Marks softirq NR pending.  From an external interrupt handler,
+   it runs when the interrupt returns.  Otherwise, ksoftirqd is
+   woken up to run it. */
+void
+softirq_raise (enum softirq nr) 
+{
+  enum intr_level old_level;
+
+  ASSERT (nr < SOFTIRQ_CNT);
+
+  old_level = intr_disable ();
+  pending |= 1u << nr;
+  if (!intr_context ())
+    wake_ksoftirqd ();
+  intr_set_level (old_level);
+}
+
+/* Returns true if any softirq is pending. */
+bool
+softirq_pending (void) 
+{
+  return pending != 0;
+}
+
+/* Runs pending softirqs, up to MAX_ROUNDS times in a row, and
+   hands any that are still pending to ksoftirqd.  Called by
+   intr_handler() on the way out of an external interrupt, in
+   softirq context, with interrupts off.  Returns with interrupts
+   off. */
+void
+softirq_run (void) 
+{
+  int round;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (intr_context ());
+
+  for (round = 0; round < MAX_ROUNDS && pending != 0; round++)
+    run_round ();
+  if (pending != 0)
+    {
+      deferred_cnt++;
+      wake_ksoftirqd ();
+    }
+}
+
+/* Prints softirq statistics. */
+void
+softirq_print_stats (void) 
+{
+  int i;
+
+  printf ("Softirq:");
+  for (i = 0; i < SOFTIRQ_CNT; i++)
+    if (handlers[i] != NULL)
+      printf (" %lld %s,", run_cnt[i], names[i]);
+  printf (" %lld deferred to ksoftirqd\n", deferred_cnt);
+}
+
+/* Runs each softirq that is pending, once, with interrupts on.
+   Must be called with interrupts off.  Returns with interrupts
+   off. */
+static void
+run_round (void) 
+{
+  unsigned todo = pending;
+  int i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  pending = 0;
+  intr_enable ();
+  for (i = 0; i < SOFTIRQ_CNT; i++)
+    if (todo & (1u << i))
+      {
+        ASSERT (handlers[i] != NULL);
+        run_cnt[i]++;
+        handlers[i] ();
+      }
+  intr_disable ();
+}
+
+/* Wakes up ksoftirqd, if it has been started.  Interrupts must
+   be off. */
+static void
+wake_ksoftirqd (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (ksoftirqd != NULL && ksoftirqd_sema.value == 0)
+    sema_up (&ksoftirqd_sema);
+}
+
+/* Runs softirqs that the interrupt return path left over, one
+   round at a time, yielding whenever the scheduler asks. */
+static void
+ksoftirqd_thread (void *aux UNUSED) 
+{
+  ksoftirqd = thread_current ();
+  for (;;) 
+    {
+      sema_down (&ksoftirqd_sema);
+
+      intr_disable ();
+      while (pending != 0)
+        {
+          intr_softirq_enter ();
+          run_round ();
+          if (intr_softirq_exit ())
+            thread_yield_preempted ();
+        }
+      intr_enable ();
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef THREADS_SOFTIRQ_H
+#define THREADS_SOFTIRQ_H
+
+#include <stdbool.h>
+
+/* Softirqs.
+
+   An external interrupt handler does only the work that must be
+   done with interrupts off, then raises a softirq to do the
+   rest.  Pending softirqs run when the outermost external
+   interrupt returns, after the PIC has been acknowledged and
+   with interrupts turned back on, but before any yield that the
+   handler requested.
+
+   Softirq handlers run in interrupt context: intr_context()
+   returns true, so they may not sleep, and preemption is
+   deferred until they are done.  They are never nested and a
+   given softirq never runs concurrently with itself.
+
+   If softirqs keep being raised while they run, the interrupt
+   return path gives up after a few rounds and leaves the rest to
+   the ksoftirqd thread, which competes with other threads for
+   the CPU, so that an interrupt storm cannot starve them. */
+
+/* Softirqs, in the order they run. */
+enum softirq
+  {
+    SOFTIRQ_TIMER,              /* Timer events. */
+    SOFTIRQ_SERIAL,             /* Serial port transfers. */
+    SOFTIRQ_CNT                 /* Number of softirqs. */
+  };
+
+/* A softirq handler.  Called with interrupts on. */
+typedef void softirq_func (void);
+
+void softirq_init (void);
+void softirq_register (enum softirq, softirq_func *, const char *name);
+void softirq_raise (enum softirq);
+bool softirq_pending (void);
+void softirq_run (void);
+void softirq_print_stats (void);
+
+#endif /* threads/softirq.h */
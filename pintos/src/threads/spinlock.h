@@ -0,0 +1,94 @@
+#ifndef THREADS_SPINLOCK_H
+#define THREADS_SPINLOCK_H
+
+#include <debug.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "threads/interrupt.h"
+
+/* Spin lock.
+
+   Disabling interrupts only keeps other code on the same CPU
+   out of a critical section.  State shared with other CPUs needs
+   a spin lock, which a CPU acquires by atomically swapping a 1
+   into LOCKED and busy-waiting for as long as the old value was
+   also 1.
+
+   A spin lock must only be held briefly, and never across
+   anything that can sleep.  Code that takes a spin lock that an
+   interrupt handler on the same CPU also takes must use
+   spin_lock_irqsave(), or the handler could spin forever on a
+   lock that its own CPU holds. */
+struct spinlock 
+  {
+    volatile uint32_t locked;   /* 1 if held, 0 if free. */
+  };
+
+/* Initializer for a spin lock with static storage duration. */
+#define SPINLOCK_INITIALIZER { 0 }
+
+/* Initializes LOCK as unheld. */
+static inline void
+spin_init (struct spinlock *lock) 
+{
+  lock->locked = 0;
+}
+
+/* Tries to acquire LOCK without spinning.  Returns true if
+   successful, false if LOCK was already held. */
+static inline bool
+spin_trylock (struct spinlock *lock) 
+{
+  uint32_t old = 1;
+
+  /* XCHG with a memory operand is implicitly locked, and it is
+     also a full memory barrier.  See [IA32-v2b] "XCHG". */
+  asm volatile ("xchgl %0, %1" : "+r" (old), "+m" (lock->locked)
+                : : "memory");
+  return old == 0;
+}
+
+/* Acquires LOCK, spinning until it becomes available.  While
+   waiting, only reads LOCK, so that the cache line is not
+   bounced between CPUs, and executes PAUSE, which tells the CPU
+   that this is a spin-wait loop. */
+static inline void
+spin_lock (struct spinlock *lock) 
+{
+  while (!spin_trylock (lock))
+    while (lock->locked)
+      asm volatile ("pause");
+}
+
+/* Releases LOCK, which must be held. */
+static inline void
+spin_unlock (struct spinlock *lock) 
+{
+  ASSERT (lock->locked);
+
+  /* Stores are not reordered with older loads or stores on x86,
+     so a compiler barrier suffices to keep the critical
+     section's accesses before the release. */
+  asm volatile ("" : : : "memory");
+  lock->locked = 0;
+}
+
+/* Disables interrupts, acquires LOCK, and returns the previous
+   interrupt level, to be passed to spin_unlock_irqrestore(). */
+static inline enum intr_level
+spin_lock_irqsave (struct spinlock *lock) 
+{
+  enum intr_level old_level = intr_disable ();
+  spin_lock (lock);
+  return old_level;
+}
+
+/* Releases LOCK and restores interrupt level OLD_LEVEL. */
+static inline void
+spin_unlock_irqrestore (struct spinlock *lock, enum intr_level old_level) 
+{
+  spin_unlock (lock);
+  intr_set_level (old_level);
+}
+
+#endif /* threads/spinlock.h */
@@ -29,9 +29,32 @@
 #include "threads/synch.h"
 #include <stdio.h>
 #include <string.h>
+#include "devices/timer.h"
 #include "threads/interrupt.h"
+#include "threads/latency.h"
+#include "threads/lockstat.h"
 #include "threads/thread.h"
 
+/* One semaphore in a condition variable's waiter heap. */
+struct semaphore_elem
+  {
+    struct heap_elem elem;              /* Heap element. */
+    struct semaphore semaphore;         /* This semaphore. */
+    struct thread *thread;              /* Thread waiting on it. */
+    struct condition *cond;             /* Condition it is waiting for. */
+    unsigned seq;                       /* Order of arrival. */
+  };
+
+/* Source of arrival order numbers for waiters, so that waiters
+   with equal priorities are woken first-come, first-served. */
+static unsigned next_wait_seq;
+
+static heap_less_func sema_waiter_less;
+static heap_less_func cond_waiter_less;
+static bool waiter_less (int pri_a, unsigned seq_a, int pri_b, unsigned seq_b);
+static void cond_enqueue (struct condition *, struct semaphore_elem *);
+static void take_handoff (struct lock *, struct thread *);
+
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
    manipulating it:
@@ -47,7 +70,21 @@ sema_init (struct semaphore *sema, unsigned value)
   ASSERT (sema != NULL);
 
   sema->value = value;
-  list_init (&sema->waiters);
+  heap_init (&sema->waiters, sema_waiter_less, NULL);
+  list_init (&sema->async_waiters);
+  sema->lockstat = NULL;
+}
+
+/* Puts SEMA in the lockstat class NAME, so that downs of SEMA,
+   and how long they wait, are counted if lock statistics are
+   being kept.  NAME must stay valid for as long as the kernel
+   runs. */
+void
+sema_set_name (struct semaphore *sema, const char *name)
+{
+  ASSERT (sema != NULL);
+
+  sema->lockstat = lockstat_class (name);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -61,18 +98,102 @@ void
 sema_down (struct semaphore *sema)
 {
   enum intr_level old_level;
+  uint64_t wait_start = 0;
 
   ASSERT (sema != NULL);
   ASSERT (!intr_context ());
 
   old_level = intr_disable ();
+  if (sema->value == 0 && sema->lockstat != NULL)
+    wait_start = rdtsc ();
   while (sema->value == 0)
     {
-      list_push_back (&sema->waiters, &thread_current ()->elem);
+      struct thread *cur = thread_current ();
+
+      cur->waiting_sema = sema;
+      cur->wait_seq = next_wait_seq++;
+      heap_insert (&sema->waiters, &cur->wait_elem);
       thread_block ();
     }
   sema->value--;
+  if (sema->lockstat != NULL)
+    lockstat_acquired (sema->lockstat, wait_start);
+  intr_set_level (old_level);
+}
+
+/* A thread waiting in sema_down_timeout(). */
+struct sema_timeout
+  {
+    struct thread *thread;      /* Waiting thread. */
+    bool expired;               /* Has the timeout expired? */
+  };
+
+/* Timer callback for sema_down_timeout(). */
+static void
+sema_timeout_expired (void *st_)
+{
+  struct sema_timeout *st = st_;
+
+  st->expired = true;
+  if (st->thread->waiting_sema != NULL)
+    {
+      struct semaphore *sema = st->thread->waiting_sema;
+
+      heap_remove (&sema->waiters, &st->thread->wait_elem);
+      st->thread->waiting_sema = NULL;
+      thread_unblock (st->thread);
+    }
+}
+
+/* Down or "P" operation on a semaphore that gives up after
+   TIMEOUT timer ticks.  Returns true if SEMA was decremented,
+   false if the timeout expired first.  A TIMEOUT of 0 or less
+   is like sema_try_down().
+
+   This function may sleep, so it must not be called within an
+   interrupt handler.  This function may be called with
+   interrupts disabled, but if it sleeps then the next scheduled
+   thread will probably turn interrupts back on. */
+bool
+sema_down_timeout (struct semaphore *sema, int64_t timeout)
+{
+  struct sema_timeout st;
+  struct timer_event event;
+  enum intr_level old_level;
+  uint64_t wait_start = 0;
+  bool success;
+
+  ASSERT (sema != NULL);
+  ASSERT (!intr_context ());
+
+  old_level = intr_disable ();
+  if (sema->value == 0 && timeout > 0)
+    {
+      if (sema->lockstat != NULL)
+        wait_start = rdtsc ();
+      st.thread = thread_current ();
+      st.expired = false;
+      timer_add (&event, timer_ticks () + timeout, sema_timeout_expired, &st);
+      while (sema->value == 0 && !st.expired)
+        {
+          st.thread->waiting_sema = sema;
+          st.thread->wait_seq = next_wait_seq++;
+          heap_insert (&sema->waiters, &st.thread->wait_elem);
+          thread_block ();
+        }
+      timer_cancel (&event);
+    }
+
+  success = sema->value > 0;
+  if (success)
+    {
+      sema->value--;
+      if (sema->lockstat != NULL)
+        lockstat_acquired (sema->lockstat, wait_start);
+    }
   intr_set_level (old_level);
+
+  return success;
 }
 
 /* Down or "P" operation on a semaphore, but only if the
@@ -92,6 +213,8 @@ sema_try_down (struct semaphore *sema)
   if (sema->value > 0)
     {
       sema->value--;
+      if (sema->lockstat != NULL)
+        lockstat_acquired (sema->lockstat, 0);
       success = true;
     }
   else
@@ -101,8 +224,64 @@ sema_try_down (struct semaphore *sema)
   return success;
 }
 
+/* Down operation on a semaphore that does not sleep.  If SEMA's
+   value is positive, decrements it and returns true.  Otherwise
+   queues W on SEMA and returns false; a later sema_up() then
+   completes the down on W's behalf and calls W's wake function.
+
+   Downs through W are not counted by lockstat.  This function
+   may be called from an interrupt handler. */
+bool
+sema_down_async (struct semaphore *sema, struct sema_waiter *w)
+{
+  enum intr_level old_level;
+  bool success;
+
+  ASSERT (sema != NULL);
+  ASSERT (w != NULL && w->wake != NULL);
+
+  old_level = intr_disable ();
+  success = sema->value > 0;
+  if (success)
+    sema->value--;
+  else
+    {
+      w->seq = next_wait_seq++;
+      list_push_back (&sema->async_waiters, &w->elem);
+    }
+  intr_set_level (old_level);
+
+  return success;
+}
+
+/* Returns true if the first of SEMA's async waiters should be
+   woken before any of its waiting threads.  Interrupts must be
+   off. */
+static bool
+async_waiter_first (struct semaphore *sema)
+{
+  const struct sema_waiter *w;
+  const struct thread *t;
+
+  if (list_empty (&sema->async_waiters))
+    return false;
+  if (heap_empty (&sema->waiters))
+    return true;
+
+  w = list_entry (list_front (&sema->async_waiters),
+                  struct sema_waiter, elem);
+  t = heap_entry (heap_min (&sema->waiters), struct thread, wait_elem);
+  return waiter_less (w->priority, w->seq, t->priority, t->wait_seq);
+}
+
 /* Up or "V" operation on a semaphore.  Increments SEMA's value
-   and wakes up one thread of those waiting for SEMA, if any.
+   and wakes up the highest-priority thread of those waiting for
+   SEMA, if any, the one that has waited longest among equals.
+   Yields if the woken thread has a higher priority than the
+   running thread and interrupts were on.
+
+   If an async waiter comes first instead, the up goes straight
+   to it, and it is woken without incrementing the value.
 
    This function may be called from an interrupt handler. */
 void
@@ -113,11 +292,26 @@ sema_up (struct semaphore *sema)
   ASSERT (sema != NULL);
 
   old_level = intr_disable ();
-  if (!list_empty (&sema->waiters))
-    thread_unblock (list_entry (list_pop_front (&sema->waiters),
-                                struct thread, elem));
-  sema->value++;
+  if (async_waiter_first (sema))
+    {
+      struct list_elem *e = list_pop_front (&sema->async_waiters);
+      struct sema_waiter *w = list_entry (e, struct sema_waiter, elem);
+      w->wake (w);
+    }
+  else
+    {
+      if (!heap_empty (&sema->waiters))
+        {
+          struct thread *t = heap_entry (heap_pop_min (&sema->waiters),
+                                         struct thread, wait_elem);
+          t->waiting_sema = NULL;
+          thread_unblock (t);
+        }
+      sema->value++;
+    }
   intr_set_level (old_level);
+
+  thread_preempt ();
 }
 
 static void sema_test_helper (void *sema_);
@@ -171,20 +365,34 @@ sema_test_helper (void *sema_)
    another one "up" it, but with a lock the same thread must both
    acquire and release it.  When these restrictions prove
    onerous, it's a good sign that a semaphore should be used,
-   instead of a lock. */
+   instead of a lock.
+
+   NAME is the lock's lockstat class.  lock_init(), a macro,
+   passes the caller's file and line.  NAME must stay valid for
+   as long as the kernel runs. */
 void
-lock_init (struct lock *lock)
+lock_init_named (struct lock *lock, const char *name)
 {
   ASSERT (lock != NULL);
 
   lock->holder = NULL;
   sema_init (&lock->semaphore, 1);
+  sema_set_name (&lock->semaphore, name);
+  list_init (&lock->handoff);
+  lock->acquired_tsc = 0;
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
    necessary.  The lock must not already be held by the current
    thread.
 
+   While waiting, the current thread donates its priority to the
+   lock's holder, and through it to any chain of threads the
+   holder is itself waiting on (see thread_donate_priority()).
+   When the lock changes hands, the threads still waiting for it
+   go on donating to the new holder.  Donation is not used by the
+   multi-level feedback queue scheduler.
+
    This function may sleep, so it must not be called within an
    interrupt handler.  This function may be called with
    interrupts disabled, but interrupts will be turned back on if
@@ -192,12 +400,57 @@ lock_init (struct lock *lock)
 void
 lock_acquire (struct lock *lock)
 {
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (!lock_held_by_current_thread (lock));
 
+  old_level = intr_disable ();
+  if (!thread_mlfqs && !thread_stride && lock->semaphore.value == 0)
+    {
+      /* We are going to wait.  Donate to the holder, or, if the
+         lock has just been released and its next holder has not
+         run yet, leave our donation for that thread to collect. */
+      cur->waiting_lock = lock;
+      if (lock->holder != NULL)
+        {
+          list_push_back (&lock->holder->donors, &cur->donor_elem);
+          thread_donate_priority (cur);
+        }
+      else
+        list_push_back (&lock->handoff, &cur->donor_elem);
+    }
+
   sema_down (&lock->semaphore);
-  lock->holder = thread_current ();
+  if (cur->waiting_lock != NULL)
+    {
+      /* lock_release() moved us to LOCK's handoff list. */
+      list_remove (&cur->donor_elem);
+      cur->waiting_lock = NULL;
+    }
+  take_handoff (lock, cur);
+  if (lock->semaphore.lockstat != NULL)
+    lock->acquired_tsc = rdtsc ();
+  intr_set_level (old_level);
+}
+
+/* Makes CUR the holder of LOCK, and the threads left waiting for
+   LOCK by its last release donors to CUR.  Interrupts must be
+   off. */
+static void
+take_handoff (struct lock *lock, struct thread *cur) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  lock->holder = cur;
+  if (!list_empty (&lock->handoff))
+    {
+      while (!list_empty (&lock->handoff))
+        list_push_back (&cur->donors, list_pop_front (&lock->handoff));
+      thread_update_priority (cur);
+    }
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -209,18 +462,28 @@ lock_acquire (struct lock *lock)
 bool
 lock_try_acquire (struct lock *lock)
 {
+  enum intr_level old_level;
   bool success;
 
   ASSERT (lock != NULL);
   ASSERT (!lock_held_by_current_thread (lock));
 
+  old_level = intr_disable ();
   success = sema_try_down (&lock->semaphore);
   if (success)
-    lock->holder = thread_current ();
+    {
+      take_handoff (lock, thread_current ());
+      if (lock->semaphore.lockstat != NULL)
+        lock->acquired_tsc = rdtsc ();
+    }
+  intr_set_level (old_level);
   return success;
 }
 
 /* Releases LOCK, which must be owned by the current thread.
+   Withdraws the priority donated by the threads waiting for
+   LOCK, so the current thread may yield as a result.  Their
+   donations are handed over to the lock's next holder.
 
    An interrupt handler cannot acquire a lock, so it does not
    make sense to try to release a lock within an interrupt
@@ -228,11 +491,38 @@ lock_try_acquire (struct lock *lock)
 void
 lock_release (struct lock *lock)
 {
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (lock_held_by_current_thread (lock));
 
+  old_level = intr_disable ();
+  if (!thread_mlfqs && !thread_stride)
+    {
+      struct list_elem *e;
+
+      for (e = list_begin (&cur->donors); e != list_end (&cur->donors); )
+        {
+          struct thread *donor = list_entry (e, struct thread, donor_elem);
+          if (donor->waiting_lock == lock)
+            {
+              e = list_remove (e);
+              list_push_back (&lock->handoff, &donor->donor_elem);
+            }
+          else
+            e = list_next (e);
+        }
+      thread_update_priority (cur);
+    }
+
+  if (lock->semaphore.lockstat != NULL)
+    lockstat_released (lock->semaphore.lockstat, lock->acquired_tsc);
   lock->holder = NULL;
   sema_up (&lock->semaphore);
+  intr_set_level (old_level);
+
+  thread_preempt ();
 }
 
 /* Returns true if the current thread holds LOCK, false
@@ -246,13 +536,6 @@ lock_held_by_current_thread (const struct lock *lock)
   return lock->holder == thread_current ();
 }
 
-/* One semaphore in a list. */
-struct semaphore_elem
-  {
-    struct list_elem elem;              /* List element. */
-    struct semaphore semaphore;         /* This semaphore. */
-  };
-
 /* Initializes condition variable COND.  A condition variable
    allows one piece of code to signal a condition and cooperating
    code to receive the signal and act upon it. */
@@ -261,7 +544,7 @@ cond_init (struct condition *cond)
 {
   ASSERT (cond != NULL);
 
-  list_init (&cond->waiters);
+  heap_init (&cond->waiters, cond_waiter_less, NULL);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -294,16 +577,58 @@ cond_wait (struct condition *cond, struct lock *lock)
   ASSERT (!intr_context ());
   ASSERT (lock_held_by_current_thread (lock));
 
-  sema_init (&waiter.semaphore, 0);
-  list_push_back (&cond->waiters, &waiter.elem);
+  cond_enqueue (cond, &waiter);
   lock_release (lock);
   sema_down (&waiter.semaphore);
   lock_acquire (lock);
 }
 
+/* Like cond_wait(), but gives up waiting after TIMEOUT timer
+   ticks.  Returns true if COND was signaled, false if the
+   timeout expired first.  Either way, LOCK is held again on
+   return.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+bool
+cond_wait_timeout (struct condition *cond, struct lock *lock,
+                   int64_t timeout)
+{
+  struct semaphore_elem waiter;
+  bool signaled;
+
+  ASSERT (cond != NULL);
+  ASSERT (lock != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (lock_held_by_current_thread (lock));
+  
+  cond_enqueue (cond, &waiter);
+  lock_release (lock);
+  signaled = sema_down_timeout (&waiter.semaphore, timeout);
+  lock_acquire (lock);
+
+  /* A signal may have raced with the timeout.  Signalers hold
+     LOCK, so now that we hold it again, either the waiter has
+     been taken off COND's list and its semaphore raised, or
+     neither. */
+  if (!signaled)
+    {
+      signaled = sema_try_down (&waiter.semaphore);
+      if (!signaled)
+        {
+          enum intr_level old_level = intr_disable ();
+          heap_remove (&cond->waiters, &waiter.elem);
+          waiter.thread->cond_waiter = NULL;
+          intr_set_level (old_level);
+        }
+    }
+  return signaled;
+}
+
 /* If any threads are waiting on COND (protected by LOCK), then
-   this function signals one of them to wake up from its wait.
-   LOCK must be held before calling this function.
+   this function signals the highest-priority one of them to
+   wake up from its wait, the one that has waited longest among
+   equals.  LOCK must be held before calling this function.
 
    An interrupt handler cannot acquire a lock, so it does not
    make sense to try to signal a condition variable within an
@@ -316,9 +641,17 @@ cond_signal (struct condition *cond, struct lock *lock UNUSED)
   ASSERT (!intr_context ());
   ASSERT (lock_held_by_current_thread (lock));
 
-  if (!list_empty (&cond->waiters))
-    sema_up (&list_entry (list_pop_front (&cond->waiters),
-                          struct semaphore_elem, elem)->semaphore);
+  if (!heap_empty (&cond->waiters))
+    {
+      enum intr_level old_level = intr_disable ();
+      struct semaphore_elem *waiter
+        = heap_entry (heap_pop_min (&cond->waiters),
+                      struct semaphore_elem, elem);
+      waiter->thread->cond_waiter = NULL;
+      intr_set_level (old_level);
+
+      sema_up (&waiter->semaphore);
+    }
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -333,6 +666,244 @@ cond_broadcast (struct condition *cond, struct lock *lock)
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
 
-  while (!list_empty (&cond->waiters))
+  while (!heap_empty (&cond->waiters))
     cond_signal (cond, lock);
 }
+
+/* Initializes RW as unheld. */
+void
+rwlock_init (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  lock_init_named (&rw->lock, "rwlock");
+  cond_init (&rw->read_ok);
+  cond_init (&rw->write_ok);
+  cond_init (&rw->upgrade_ok);
+  rw->readers = 0;
+  rw->waiting_writers = 0;
+  rw->writer = NULL;
+  rw->upgrader = NULL;
+}
+
+/* Acquires RW for reading, sleeping while a writer holds it, is
+   waiting for it, or is upgrading.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_acquire_read (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->writer != thread_current ());
+
+  lock_acquire (&rw->lock);
+  while (rw->writer != NULL || rw->waiting_writers > 0
+         || rw->upgrader != NULL)
+    cond_wait (&rw->read_ok, &rw->lock);
+  rw->readers++;
+  lock_release (&rw->lock);
+}
+
+/* Releases RW, which the current thread must hold for reading. */
+void
+rwlock_release_read (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  lock_acquire (&rw->lock);
+  ASSERT (rw->readers > 0);
+  rw->readers--;
+  if (rw->upgrader != NULL)
+    {
+      if (rw->readers == 1)
+        cond_signal (&rw->upgrade_ok, &rw->lock);
+    }
+  else if (rw->readers == 0 && rw->waiting_writers > 0)
+    cond_signal (&rw->write_ok, &rw->lock);
+  lock_release (&rw->lock);
+}
+
+/* Acquires RW for writing, sleeping while anyone else holds it.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_acquire_write (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->writer != thread_current ());
+
+  lock_acquire (&rw->lock);
+  rw->waiting_writers++;
+  while (rw->writer != NULL || rw->readers > 0 || rw->upgrader != NULL)
+    cond_wait (&rw->write_ok, &rw->lock);
+  rw->waiting_writers--;
+  rw->writer = thread_current ();
+  lock_release (&rw->lock);
+}
+
+/* Releases RW, which the current thread must hold for writing.
+   Hands it to the next waiting writer if there is one, otherwise
+   to all the waiting readers. */
+void
+rwlock_release_write (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_held_for_write (rw));
+
+  lock_acquire (&rw->lock);
+  rw->writer = NULL;
+  if (rw->waiting_writers > 0)
+    cond_signal (&rw->write_ok, &rw->lock);
+  else
+    cond_broadcast (&rw->read_ok, &rw->lock);
+  lock_release (&rw->lock);
+}
+
+/* Turns the current thread's hold on RW for reading into a hold
+   for writing, waiting for the other readers to leave.  Waiting
+   writers do not get in first.  Returns true if successful.  If
+   another reader is already upgrading, upgrading would
+   deadlock, so returns false without waiting; the caller still
+   holds RW for reading and should release it and acquire it for
+   writing instead.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+bool
+rwlock_upgrade (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+
+  lock_acquire (&rw->lock);
+  ASSERT (rw->readers > 0);
+  if (rw->upgrader != NULL)
+    {
+      lock_release (&rw->lock);
+      return false;
+    }
+  rw->upgrader = thread_current ();
+  while (rw->readers > 1)
+    cond_wait (&rw->upgrade_ok, &rw->lock);
+  rw->upgrader = NULL;
+  rw->readers = 0;
+  rw->writer = thread_current ();
+  lock_release (&rw->lock);
+  return true;
+}
+
+/* Turns the current thread's hold on RW for writing into a hold
+   for reading.  Waiting readers get in too, unless a writer is
+   waiting. */
+void
+rwlock_downgrade (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_held_for_write (rw));
+
+  lock_acquire (&rw->lock);
+  rw->writer = NULL;
+  rw->readers = 1;
+  if (rw->waiting_writers == 0)
+    cond_broadcast (&rw->read_ok, &rw->lock);
+  lock_release (&rw->lock);
+}
+
+/* Returns true if the current thread holds RW for writing, false
+   otherwise.  (There is no way to tell whether it holds RW for
+   reading.) */
+bool
+rwlock_held_for_write (const struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  return rw->writer == thread_current ();
+}
+
+/* Sets T's priority to PRIORITY, keeping the waiter heaps of
+   the semaphore and condition variable that T is waiting for, if
+   any, in order.  Called by the scheduler whenever it changes the
+   priority of a thread that is not ready to run.  Interrupts
+   must be off. */
+void
+synch_change_priority (struct thread *t, int priority)
+{
+  struct semaphore *sema = t->waiting_sema;
+  struct semaphore_elem *waiter = t->cond_waiter;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  /* Heap elements must be taken out before their keys change. */
+  if (sema != NULL)
+    heap_remove (&sema->waiters, &t->wait_elem);
+  if (waiter != NULL)
+    heap_remove (&waiter->cond->waiters, &waiter->elem);
+
+  t->priority = priority;
+
+  if (sema != NULL)
+    heap_insert (&sema->waiters, &t->wait_elem);
+  if (waiter != NULL)
+    heap_insert (&waiter->cond->waiters, &waiter->elem);
+}
+
+/* Adds the running thread to COND's waiters through WAITER. */
+static void
+cond_enqueue (struct condition *cond, struct semaphore_elem *waiter)
+{
+  enum intr_level old_level;
+
+  sema_init (&waiter->semaphore, 0);
+  waiter->thread = thread_current ();
+  waiter->cond = cond;
+
+  old_level = intr_disable ();
+  waiter->seq = next_wait_seq++;
+  heap_insert (&cond->waiters, &waiter->elem);
+  waiter->thread->cond_waiter = waiter;
+  intr_set_level (old_level);
+}
+
+/* Orders a semaphore's waiter heap so that the thread to wake
+   next is at the top: highest priority first, then first come,
+   first served. */
+static bool
+sema_waiter_less (const struct heap_elem *a_, const struct heap_elem *b_,
+                  void *aux UNUSED)
+{
+  const struct thread *a = heap_entry (a_, struct thread, wait_elem);
+  const struct thread *b = heap_entry (b_, struct thread, wait_elem);
+
+  return waiter_less (a->priority, a->wait_seq, b->priority, b->wait_seq);
+}
+
+/* Orders a condition variable's waiter heap the same way as
+   sema_waiter_less(). */
+static bool
+cond_waiter_less (const struct heap_elem *a_, const struct heap_elem *b_,
+                  void *aux UNUSED)
+{
+  const struct semaphore_elem *a
+    = heap_entry (a_, struct semaphore_elem, elem);
+  const struct semaphore_elem *b
+    = heap_entry (b_, struct semaphore_elem, elem);
+
+  return waiter_less (a->thread->priority, a->seq,
+                      b->thread->priority, b->seq);
+}
+
+/* Returns true if a waiter with priority PRI_A that arrived at
+   SEQ_A should be woken before one with PRI_B that arrived at
+   SEQ_B.  Arrival numbers wrap around, so they are compared by
+   their difference. */
+static bool
+waiter_less (int pri_a, unsigned seq_a, int pri_b, unsigned seq_b)
+{
+  if (pri_a != pri_b)
+    return pri_a > pri_b;
+  return (int) (seq_a - seq_b) < 0;
+}
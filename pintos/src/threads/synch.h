@@ -1,18 +1,43 @@
 #ifndef THREADS_SYNCH_H
 #define THREADS_SYNCH_H
 
+#include <heap.h>
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
+
+struct thread;
+struct lockstat_class;
 
 /* A counting semaphore. */
 struct semaphore 
   {
     unsigned value;             /* Current value. */
-    struct list waiters;        /* List of waiting threads. */
+    struct heap waiters;        /* Waiting threads, by priority. */
+    struct list async_waiters;  /* Waiting struct sema_waiters, FIFO. */
+    struct lockstat_class *lockstat; /* Statistics, if being kept. */
+  };
+
+/* A waiter that parks on a semaphore without blocking a thread,
+   used by stackless tasks (see threads/task.h).  When the
+   semaphore is upped for it, the up is handed to it directly,
+   without incrementing the value, and WAKE is called with
+   interrupts off, possibly from an interrupt handler.  It is
+   woken in turn with waiting threads, by PRIORITY and order of
+   arrival. */
+struct sema_waiter
+  {
+    struct list_elem elem;      /* Element in async_waiters. */
+    int priority;               /* Priority, set by the owner. */
+    unsigned seq;               /* Order of arrival. */
+    void (*wake) (struct sema_waiter *); /* Called when downed. */
   };
 
 void sema_init (struct semaphore *, unsigned value);
+void sema_set_name (struct semaphore *, const char *name);
 void sema_down (struct semaphore *);
+bool sema_down_async (struct semaphore *, struct sema_waiter *);
+bool sema_down_timeout (struct semaphore *, int64_t timeout);
 bool sema_try_down (struct semaphore *);
 void sema_up (struct semaphore *);
 void sema_self_test (void);
@@ -20,11 +45,19 @@ void sema_self_test (void);
 /* Lock. */
 struct lock 
   {
-    struct thread *holder;      /* Thread holding lock (for debugging). */
+    struct thread *holder;      /* Thread holding lock. */
     struct semaphore semaphore; /* Binary semaphore controlling access. */
+    struct list handoff;        /* Donors waiting while no holder. */
+    uint64_t acquired_tsc;      /* When acquired, if keeping statistics. */
   };
 
-void lock_init (struct lock *);
+/* lock_init() names the lock's lockstat class after the file and
+   line it is called from. */
+#define lock_init(LOCK) lock_init_named (LOCK, LOCK_CALLSITE (__LINE__))
+#define LOCK_CALLSITE(LINE) LOCK_CALLSITE_ (LINE)
+#define LOCK_CALLSITE_(LINE) __FILE__ ":" #LINE
+
+void lock_init_named (struct lock *, const char *name);
 void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
@@ -33,14 +66,46 @@ bool lock_held_by_current_thread (const struct lock *);
 /* Condition variable. */
 struct condition 
   {
-    struct list waiters;        /* List of waiting threads. */
+    struct heap waiters;        /* Waiting threads, by priority. */
   };
 
 void cond_init (struct condition *);
 void cond_wait (struct condition *, struct lock *);
+bool cond_wait_timeout (struct condition *, struct lock *, int64_t timeout);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Reader-writer lock.
+
+   Any number of readers, or a single writer, may hold a
+   reader-writer lock at a time.  Writers are preferred: once a
+   writer is waiting, new readers wait until it is done.  A reader
+   may upgrade to a writer, and a writer may downgrade to a
+   reader, without letting anyone else in between.  Neither kind
+   of holding is recursive. */
+struct rwlock
+  {
+    struct lock lock;           /* Protects the members below. */
+    struct condition read_ok;   /* Signaled when readers may enter. */
+    struct condition write_ok;  /* Signaled when a writer may enter. */
+    struct condition upgrade_ok; /* Signaled when UPGRADER may proceed. */
+    int readers;                /* Number of readers holding it. */
+    int waiting_writers;        /* Number of writers waiting. */
+    struct thread *writer;      /* Writer holding it, if any. */
+    struct thread *upgrader;    /* Reader waiting to upgrade, if any. */
+  };
+
+void rwlock_init (struct rwlock *);
+void rwlock_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+bool rwlock_upgrade (struct rwlock *);
+void rwlock_downgrade (struct rwlock *);
+bool rwlock_held_for_write (const struct rwlock *);
+
+void synch_change_priority (struct thread *, int priority);
+
 /* Optimization barrier.
 
    The compiler will not reorder operations across an
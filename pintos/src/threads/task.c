@@ -0,0 +1,204 @@
+#include "threads/task.h"
+#include <debug.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+/* Number of executor threads. */
+#define EXECUTORS 2
+
+/* Workqueue whose workers are the executors. */
+static struct workqueue *task_wq;
+
+/* Statistics. */
+static long long started_cnt;   /* Tasks started. */
+static long long done_cnt;      /* Tasks finished. */
+static long long step_cnt;      /* Steps run. */
+static long long park_cnt;      /* Times a task was parked. */
+
+static work_func task_run;
+static void task_wake (struct task *);
+static void task_sema_wake (struct sema_waiter *);
+static timer_callback_func task_timer_expired;
+
+/* Creates the executor threads. */
+void
+task_pool_init (void) 
+{
+  task_wq = workqueue_create ("task", EXECUTORS, TASK_PRIORITY);
+  if (task_wq == NULL)
+    PANIC ("could not create task executors");
+}
+
+/* Initializes T as a task that runs FUNC for each step and then,
+   when FUNC returns without parking, calls DONE, which may free
+   T.  DONE may be null. */
+void
+task_init (struct task *t, task_func *func, task_func *done) 
+{
+  ASSERT (t != NULL);
+  ASSERT (func != NULL);
+
+  work_init (&t->work, task_run);
+  t->func = func;
+  t->done = done;
+  t->resume = 0;
+  t->status = TASK_PARKED;
+  t->running = false;
+  t->waiter.priority = TASK_PRIORITY;
+  t->waiter.wake = task_sema_wake;
+}
+
+/* Queues the first step of T.  May be called from an interrupt
+   handler. */
+void
+task_start (struct task *t) 
+{
+  enum intr_level old_level;
+
+  ASSERT (t != NULL);
+  ASSERT (t->resume == 0);
+
+  old_level = intr_disable ();
+  started_cnt++;
+  task_wake (t);
+  intr_set_level (old_level);
+}
+
+/* Downs SEMA on behalf of T, which must be running a step.
+   Returns true if SEMA was downed at once.  Otherwise parks T on
+   SEMA and returns false, and the step must return; T's next
+   step runs once SEMA has been downed for it.  Use
+   TASK_AWAIT() rather than calling this directly. */
+bool
+task_await (struct task *t, struct semaphore *sema) 
+{
+  enum intr_level old_level;
+  bool success;
+
+  ASSERT (t != NULL && t->running);
+  ASSERT (t->status == TASK_RUNNING);
+
+  old_level = intr_disable ();
+  t->status = TASK_PARKED;
+  success = sema_down_async (sema, &t->waiter);
+  if (success)
+    t->status = TASK_RUNNING;
+  else
+    park_cnt++;
+  intr_set_level (old_level);
+
+  return success;
+}
+
+/* Parks T, which must be running a step, for TICKS timer ticks.
+   The step must return.  Use TASK_SLEEP() rather than calling
+   this directly. */
+void
+task_sleep (struct task *t, int64_t ticks) 
+{
+  enum intr_level old_level;
+
+  ASSERT (t != NULL && t->running);
+  ASSERT (t->status == TASK_RUNNING);
+
+  if (ticks <= 0)
+    {
+      task_yield (t);
+      return;
+    }
+
+  old_level = intr_disable ();
+  t->status = TASK_PARKED;
+  park_cnt++;
+  timer_add (&t->timer, timer_ticks () + ticks, task_timer_expired, t);
+  intr_set_level (old_level);
+}
+
+/* Requeues T, which must be running a step, behind the other
+   ready tasks.  The step must return.  Use TASK_YIELD() rather
+   than calling this directly. */
+void
+task_yield (struct task *t) 
+{
+  ASSERT (t != NULL && t->running);
+  ASSERT (t->status == TASK_RUNNING);
+
+  t->status = TASK_READY;
+}
+
+/* Prints task statistics. */
+void
+task_print_stats (void) 
+{
+  printf ("Task: %lld started, %lld finished, %lld steps, %lld parks\n",
+          started_cnt, done_cnt, step_cnt, park_cnt);
+}
+
+/* Runs the next step of the task that owns WORK, in an executor
+   thread. */
+static void
+task_run (struct work *work) 
+{
+  struct task *t = (struct task *) ((uint8_t *) work
+                                    - offsetof (struct task, work));
+  enum intr_level old_level;
+  bool finished = false;
+
+  old_level = intr_disable ();
+  ASSERT (t->status == TASK_READY);
+  t->status = TASK_RUNNING;
+  t->running = true;
+  step_cnt++;
+  intr_set_level (old_level);
+
+  t->func (t);
+
+  /* A task woken while its step was still running could not be
+     queued then, so queue it now. */
+  old_level = intr_disable ();
+  t->running = false;
+  if (t->status == TASK_READY)
+    queue_work (task_wq, &t->work);
+  else if (t->status == TASK_RUNNING)
+    {
+      t->status = TASK_DONE;
+      done_cnt++;
+      finished = true;
+    }
+  intr_set_level (old_level);
+
+  if (finished && t->done != NULL)
+    t->done (t);
+}
+
+/* Makes parked task T ready and queues its next step, unless its
+   current step is still running, in which case task_run()
+   queues it.  Interrupts must be off. */
+static void
+task_wake (struct task *t) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->status == TASK_PARKED);
+
+  t->status = TASK_READY;
+  if (!t->running)
+    queue_work (task_wq, &t->work);
+}
+
+/* Called by sema_up() when it has downed a semaphore for the
+   task that owns W. */
+static void
+task_sema_wake (struct sema_waiter *w) 
+{
+  task_wake ((struct task *) ((uint8_t *) w
+                              - offsetof (struct task, waiter)));
+}
+
+/* Timer callback for task_sleep(). */
+static void
+task_timer_expired (void *t) 
+{
+  task_wake (t);
+}
@@ -0,0 +1,141 @@
+#ifndef THREADS_TASK_H
+#define THREADS_TASK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "devices/timer.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+
+/* Stackless tasks.
+
+   A kernel thread costs a page.  A task costs only a struct
+   task, embedded in a larger structure that holds its state, so
+   tens of thousands of them can be outstanding at once.  Tasks
+   run on a small pool of executor threads.
+
+   A task is a step function that is called again each time the
+   task can make progress.  Between steps the task has no stack,
+   so a step must not sleep: it waits by parking the task on a
+   semaphore or a timer and returning.  The TASK_* macros below
+   make a step function read like straight-line code:
+
+        static void
+        step (struct task *t)
+        {
+          struct request *r = ...;     (Outer structure of T.)
+
+          TASK_BEGIN (t);
+          start_io (r);
+          TASK_AWAIT (t, &r->io_done);
+          TASK_SLEEP (t, 10);
+          ...
+          TASK_END (t);
+        }
+
+   TASK_BEGIN() must come first and TASK_END() last.  Local
+   variables do not survive a TASK_AWAIT(), TASK_SLEEP() or
+   TASK_YIELD(), so keep state in the outer structure.  No two
+   of these macros may be on the same line, and they may not be
+   used inside another switch statement.
+
+   A task may await any semaphore, including one upped from an
+   interrupt handler, but not a lock or a condition variable.
+   The semaphore must be one that the task's own code ups or
+   owns, such as R->io_done above.  A task must not await a
+   semaphore that a driver downs itself, such as an IDE
+   channel's completion semaphore.  The task would take the up
+   that the thread doing the I/O is waiting for. */
+
+/* Priority at which the executors run.  Parked tasks are woken
+   in turn with waiting threads of the same priority. */
+#define TASK_PRIORITY PRI_DEFAULT
+
+struct task;
+
+/* A step function, or a task's completion function. */
+typedef void task_func (struct task *);
+
+/* States of a task. */
+enum task_status
+  {
+    TASK_READY,                 /* Queued to run its next step. */
+    TASK_RUNNING,               /* Running a step. */
+    TASK_PARKED,                /* Waiting on a semaphore or timer. */
+    TASK_DONE                   /* Finished. */
+  };
+
+/* A task.  The caller owns the storage, which must stay valid
+   until the task's completion function is called. */
+struct task
+  {
+    struct work work;           /* Runs the next step on an executor. */
+    task_func *func;            /* Step function. */
+    task_func *done;            /* Completion function, or null. */
+    int resume;                 /* Where the next step resumes. */
+    enum task_status status;    /* Current state. */
+    bool running;               /* In the step function? */
+    struct sema_waiter waiter;  /* For TASK_AWAIT(). */
+    struct timer_event timer;   /* For TASK_SLEEP(). */
+  };
+
+void task_pool_init (void);
+void task_init (struct task *, task_func *func, task_func *done);
+void task_start (struct task *);
+bool task_await (struct task *, struct semaphore *);
+void task_sleep (struct task *, int64_t ticks);
+void task_yield (struct task *);
+void task_print_stats (void);
+
+/* Marks the deliberate fall through from a TASK_AWAIT() that
+   did not have to park into its resume point. */
+#if __GNUC__ >= 7
+#define TASK_FALLTHROUGH __attribute__ ((fallthrough))
+#else
+#define TASK_FALLTHROUGH do { } while (0)
+#endif
+
+/* Starts the body of step function of task T. */
+#define TASK_BEGIN(T) switch ((T)->resume) { case 0:
+
+/* Ends the body of step function of task T.  Reaching it
+   finishes the task. */
+#define TASK_END(T) }
+
+/* Downs SEMA on behalf of task T, parking T until it can.  If
+   SEMA can be downed at once, T just carries on. */
+#define TASK_AWAIT(T, SEMA)                                     \
+        do                                                      \
+          {                                                     \
+            (T)->resume = __LINE__;                             \
+            if (!task_await (T, SEMA))                          \
+              return;                                           \
+            TASK_FALLTHROUGH;                                   \
+            case __LINE__:;                                     \
+          }                                                     \
+        while (0)
+
+/* Parks task T for TICKS timer ticks. */
+#define TASK_SLEEP(T, TICKS)                                    \
+        do                                                      \
+          {                                                     \
+            (T)->resume = __LINE__;                             \
+            task_sleep (T, TICKS);                              \
+            return;                                             \
+            case __LINE__:;                                     \
+          }                                                     \
+        while (0)
+
+/* Lets other tasks run before task T continues. */
+#define TASK_YIELD(T)                                           \
+        do                                                      \
+          {                                                     \
+            (T)->resume = __LINE__;                             \
+            task_yield (T);                                     \
+            return;                                             \
+            case __LINE__:;                                     \
+          }                                                     \
+        while (0)
+
+#endif /* threads/task.h */
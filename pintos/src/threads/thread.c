@@ -1,16 +1,20 @@
 #include "threads/thread.h"
 #include <debug.h>
+#include <inttypes.h>
 #include <stddef.h>
 #include <random.h>
 #include <stdio.h>
 #include <string.h>
+#include "devices/timer.h"
 #include "threads/flags.h"
+#include "threads/fpu.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
 #include "threads/palloc.h"
 #include "threads/switch.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "threads/workqueue.h"
 #include "userprog/process.h"
 #ifdef USERPROG
 #include "userprog/process.h"
@@ -21,14 +25,44 @@
    of thread.h for details. */
 #define THREAD_MAGIC 0xcd6abf4b
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
+/* Lists of processes in THREAD_READY state, that is, processes
+   that are ready to run but not actually running.  There is one
+   list per scheduling priority, normal and real-time, each kept
+   in FIFO order so that threads of equal priority are run
+   round-robin.  (SCHED_DEADLINE threads wait in dl_heap instead,
+   but a thread that inherits priority PRI_DL by donation goes in
+   ready_lists[PRI_DL].) */
+static struct list ready_lists[PRI_DL + 1];
+
+/* Bitmap of nonempty ready lists: bit P of ready_mask[P / 32]
+   is set if and only if ready_lists[P] is nonempty.  Lets
+   next_thread_to_run() find the highest-priority ready thread
+   with a single `bsr' per word, however many threads are
+   ready. */
+#define READY_MASK_WORDS ((PRI_DL + 32) / 32)
+static uint32_t ready_mask[READY_MASK_WORDS];
+static int ready_count;         /* # of threads in the ready lists. */
+
+/* Ready SCHED_DEADLINE threads, ordered by absolute deadline. */
+static struct heap dl_heap;
+
+/* Maximum total bandwidth of SCHED_DEADLINE threads, as a
+   fraction of the CPU.  The rest is left for everyone else. */
+#define DL_BANDWIDTH_MAX (FP_ONE * 95 / 100)
+static fixed_t dl_bandwidth;    /* Bandwidth admitted so far. */
 
 /* List of all processes.  Processes are added to this list
    when they are first scheduled and removed when they exit. */
 static struct list all_list;
 
+/* Guards all_list.  Walks of the list from thread context, such
+   as printing statistics, take it for reading and so do not
+   hold off interrupts; threads being created and exiting take
+   it for writing.  Changes to the list are also made with
+   interrupts off, so walks from interrupt context, or with
+   interrupts off, may skip the lock. */
+static struct rwlock all_lock;
+
 /* Idle thread. */
 static struct thread *idle_thread;
 
@@ -38,6 +72,16 @@ static struct thread *initial_thread;
 /* Lock used by allocate_tid(). */
 static struct lock tid_lock;
 
+/* Cache of pages freed by dying threads, for reuse by
+   thread_create() without going through the page allocator.
+   The pages are chained through their first word.  At most
+   THREAD_CACHE_MAX pages are kept; beyond that, they are
+   returned to the page allocator by system_wq.  Accessed only
+   with interrupts off. */
+#define THREAD_CACHE_MAX 16
+static void *thread_cache;
+static size_t thread_cache_cnt;
+
 /* Stack frame for kernel_thread(). */
 struct kernel_thread_frame
   {
@@ -52,7 +96,7 @@ static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
 static long long user_ticks;    /* # of timer ticks in user programs. */
 
 /* Scheduling. */
-#define TIME_SLICE 4            /* # of timer ticks to give each thread. */
+#define TIME_SLICE 4            /* Default # of timer ticks per slice. */
 static unsigned thread_ticks;   /* # of timer ticks since last yield. */
 
 /* If false (default), use round-robin scheduler.
@@ -60,17 +104,77 @@ static unsigned thread_ticks;   /* # of timer ticks since last yield. */
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* Multi-level feedback queue scheduler. */
+static fixed_t load_avg;        /* System load average. */
+
+/* Threads whose recent_cpu or nice is nonzero.  Only these
+   threads' recent_cpu and priority can change in the
+   once-per-second recomputation: a thread with both values zero
+   keeps a recent_cpu of 0 and a priority of PRI_MAX whatever the
+   load average, so there is no need to visit it. */
+static struct list mlfqs_list;
+
+/* If true, schedule SCHED_OTHER threads by stride scheduling.
+   Controlled by kernel command-line option "-stride".
+
+   Each such thread holds a number of tickets and advances its
+   `pass' by its stride, STRIDE1 / tickets, for each tick it runs.
+   The ready thread with the smallest pass runs next, so over
+   time every thread receives CPU time in proportion to its
+   tickets.  global_pass advances in the same way for the system
+   as a whole, at the rate of the total tickets of the threads
+   that are runnable.  A thread that blocks saves the distance
+   between its pass and global_pass in `remain', and when it
+   wakes up its pass is set to global_pass plus that distance, so
+   it neither hoards CPU time by sleeping nor loses its place.
+   Real-time threads still run ahead of stride threads. */
+bool thread_stride;
+
+#define STRIDE1 (1 << 20)       /* Stride of a 1-ticket thread. */
+static struct heap stride_heap; /* Ready stride threads, by pass. */
+static int64_t global_pass;     /* Pass of the system. */
+static int global_tickets;      /* Tickets of runnable stride threads. */
+
 static void kernel_thread (thread_func *, void *aux);
 
 static void idle (void *aux UNUSED);
 static struct thread *running_thread (void);
 static struct thread *next_thread_to_run (void);
 static void init_thread (struct thread *, const char *name, int priority);
+static void all_list_add (struct thread *);
+static void all_list_remove (struct thread *);
 static bool is_thread (struct thread *) UNUSED;
 static void *alloc_frame (struct thread *, size_t size);
 static void schedule (void);
 void thread_schedule_tail (struct thread *prev);
 static tid_t allocate_tid (void);
+static void yield (bool voluntary);
+static void set_status (struct thread *, enum thread_status);
+static struct thread *thread_page_get (void);
+static void thread_page_free (struct thread *);
+static work_func thread_page_reap;
+static void ready_push (struct thread *);
+static void ready_push_front (struct thread *);
+static struct thread *ready_pop (void);
+static int ready_max_priority (void);
+static void ready_remove (struct thread *);
+static void change_priority (struct thread *, int priority);
+static int own_priority (const struct thread *);
+static void mlfqs_tick (struct thread *);
+static void mlfqs_track (struct thread *);
+static int mlfqs_priority (const struct thread *);
+static bool stride_client (const struct thread *);
+static void stride_join (struct thread *);
+static void stride_leave (struct thread *);
+static void stride_tick (struct thread *);
+static heap_less_func pass_less;
+static void dl_new_period (struct thread *, int64_t start);
+static void dl_tick (struct thread *);
+static void dl_throttle (struct thread *);
+static void dl_unthrottle (struct thread *);
+static timer_callback_func dl_replenish;
+static heap_less_func deadline_less;
+static bool should_preempt (struct thread *);
 
 /* Initializes the threading system by transforming the code
    that's currently running into a thread.  This can't work in
@@ -88,17 +192,27 @@ static tid_t allocate_tid (void);
 void
 thread_init (void)
 {
+  int i;
+
   ASSERT (intr_get_level () == INTR_OFF);
 
   lock_init (&tid_lock);
-  list_init (&ready_list);
+  for (i = 0; i <= PRI_DL; i++)
+    list_init (&ready_lists[i]);
   list_init (&all_list);
+  rwlock_init (&all_lock);
+  list_init (&mlfqs_list);
+  heap_init (&stride_heap, pass_less, NULL);
+  heap_init (&dl_heap, deadline_less, NULL);
 
   /* Set up a thread structure for the running thread. */
   initial_thread = running_thread ();
   init_thread (initial_thread, "main", PRI_DEFAULT);
+  list_push_back (&all_list, &initial_thread->allelem);
   initial_thread->status = THREAD_RUNNING;
   initial_thread->tid = allocate_tid ();
+  if (stride_client (initial_thread))
+    stride_join (initial_thread);
 }
 
 /* Starts preemptive thread scheduling by enabling interrupts.
@@ -126,6 +240,7 @@ thread_tick (void)
   struct thread *t = thread_current ();
 
   /* Update statistics. */
+  t->stats.cpu_ticks++;
   if (t == idle_thread)
     idle_ticks++;
 #ifdef USERPROG
@@ -135,8 +250,24 @@ thread_tick (void)
   else
     kernel_ticks++;
 
-  /* Enforce preemption. */
-  if (++thread_ticks >= TIME_SLICE)
+  if (thread_mlfqs)
+    mlfqs_tick (t);
+  else if (stride_client (t))
+    stride_tick (t);
+
+  /* Enforce preemption.  SCHED_FIFO threads have no time slice:
+     they run until they block or yield, or a higher-priority
+     thread becomes ready.  SCHED_DEADLINE threads run until
+     they run out of budget or an earlier deadline comes up. */
+  if (t->policy == SCHED_DEADLINE)
+    dl_tick (t);
+  else if (t->policy != SCHED_FIFO && ++thread_ticks >= t->quantum)
+    intr_yield_on_return ();
+
+  /* Carry out a preemption that was put off because interrupts
+     were off, if the thread has not reached a preemption point
+     since. */
+  if (t->need_resched)
     intr_yield_on_return ();
 }
 
@@ -148,6 +279,46 @@ thread_print_stats (void)
           idle_ticks, kernel_ticks, user_ticks);
 }
 
+/* thread_foreach() callback that prints T's scheduling
+   statistics. */
+static void
+print_schedstat (struct thread *t, void *aux UNUSED)
+{
+  struct schedstat s;
+
+  thread_get_schedstat (t, &s);
+  printf ("Schedstat: %5d %-16s %5lld %7lld %7lld %4"PRIu32" %5"PRIu32
+          " %8lld\n", t->tid, t->name, s.cpu_ticks, s.ready_ticks,
+          s.blocked_ticks, s.voluntary_switches, s.involuntary_switches,
+          s.last_run);
+}
+
+/* Prints the scheduling statistics of each live thread. */
+void
+thread_print_schedstats (void)
+{
+  printf ("Schedstat:   tid name             cpu   ready blocked"
+          "  vol invol last-run\n");
+  thread_foreach (print_schedstat, NULL);
+}
+
+/* Stores T's scheduling statistics into *STATS, including the
+   time T has spent in its current state so far. */
+void
+thread_get_schedstat (struct thread *t, struct schedstat *stats)
+{
+  enum intr_level old_level = intr_disable ();
+
+  ASSERT (is_thread (t));
+
+  *stats = t->stats;
+  if (t->status == THREAD_READY)
+    stats->ready_ticks += timer_ticks () - t->state_since;
+  else if (t->status == THREAD_BLOCKED)
+    stats->blocked_ticks += timer_ticks () - t->state_since;
+  intr_set_level (old_level);
+}
+
 /* Creates a new kernel thread named NAME with the given initial
    PRIORITY, which executes FUNCTION passing AUX as the argument,
    and adds it to the ready queue.  Returns the thread identifier
@@ -160,9 +331,9 @@ thread_print_stats (void)
    scheduled.  Use a semaphore or some other form of
    synchronization if you need to ensure ordering.
 
-   The code provided sets the new thread's `priority' member to
-   PRIORITY, but no actual priority scheduling is implemented.
-   Priority scheduling is the goal of Problem 1-3. */
+   If the new thread has a higher priority than the running
+   thread, and interrupts are on, the running thread yields to
+   it before thread_create() returns. */
 tid_t
 thread_create (const char *name, int priority,
                thread_func *function, void *aux)
@@ -177,13 +348,14 @@ thread_create (const char *name, int priority,
   ASSERT (function != NULL);
 
   /* Allocate thread. */
-  t = palloc_get_page (PAL_ZERO);
+  t = thread_page_get ();
   if (t == NULL)
     return TID_ERROR;
 
   /* Initialize thread. */
   init_thread (t, name, priority);
   tid = t->tid = allocate_tid ();
+  all_list_add (t);
 
   //Aggiunto
   t->fd_count = 1;
@@ -201,6 +373,31 @@ thread_create (const char *name, int priority,
      member cannot be observed. */
   old_level = intr_disable ();
 
+  /* Under the multi-level feedback queue scheduler, the PRIORITY
+     argument is ignored: the new thread inherits its parent's
+     nice and recent_cpu values and its priority follows from
+     them. */
+  if (thread_mlfqs && function != idle)
+    {
+      struct thread *cur = thread_current ();
+
+      t->nice = cur->nice;
+      t->recent_cpu = cur->recent_cpu;
+      t->priority = mlfqs_priority (t);
+      mlfqs_track (t);
+    }
+
+  /* Likewise under the stride scheduler, where a thread's share
+     is set by its tickets instead.  The idle thread holds no
+     tickets, so that it never competes with the others. */
+  if (thread_stride)
+    {
+      if (function != idle)
+        t->priority = t->base_priority = PRI_DEFAULT;
+      else
+        t->tickets = 0;
+    }
+
   /* Stack frame for kernel_thread(). */
   kf = alloc_frame (t, sizeof *kf);
   kf->eip = NULL;
@@ -211,8 +408,10 @@ thread_create (const char *name, int priority,
   ef = alloc_frame (t, sizeof *ef);
   ef->eip = (void (*) (void)) kernel_thread;
 
-  /* Stack frame for switch_threads(). */
+  /* Stack frame for switch_threads().  The page may be recycled
+     from a dead thread, so don't count on it being zeroed. */
   sf = alloc_frame (t, sizeof *sf);
+  memset (sf, 0, sizeof *sf);
   sf->eip = switch_entry;
   sf->ebp = 0;
 
@@ -236,7 +435,10 @@ thread_block (void)
   ASSERT (!intr_context ());
   ASSERT (intr_get_level () == INTR_OFF);
 
-  thread_current ()->status = THREAD_BLOCKED;
+  thread_current ()->stats.voluntary_switches++;
+  if (stride_client (thread_current ()))
+    stride_leave (thread_current ());
+  set_status (thread_current (), THREAD_BLOCKED);
   schedule ();
 }
 
@@ -244,10 +446,13 @@ thread_block (void)
    This is an error if T is not blocked.  (Use thread_yield() to
    make the running thread ready.)
 
-   This function does not preempt the running thread.  This can
-   be important: if the caller had disabled interrupts itself,
-   it may expect that it can atomically unblock a thread and
-   update other data. */
+   If T has a higher priority than the running thread, the
+   running thread is preempted, but only if the caller had
+   interrupts turned on (see thread_preempt()).  This can be
+   important: if the caller had disabled interrupts itself, it
+   may expect that it can atomically unblock a thread and update
+   other data.  Such callers should call thread_preempt() once
+   they turn interrupts back on. */
 void
 thread_unblock (struct thread *t)
 {
@@ -257,9 +462,23 @@ thread_unblock (struct thread *t)
 
   old_level = intr_disable ();
   ASSERT (t->status == THREAD_BLOCKED);
-  list_push_back (&ready_list, &t->elem);
-  t->status = THREAD_READY;
-  intr_set_level(old_level);
+  if (t->dl_throttled)
+    {
+      /* Out of budget: stay blocked until dl_replenish(). */
+      t->dl_parked = true;
+      intr_set_level (old_level);
+      return;
+    }
+  if (stride_client (t))
+    stride_join (t);
+  if (t->policy == SCHED_DEADLINE && timer_ticks () >= t->dl_next_period)
+    dl_new_period (t, timer_ticks ());
+  ready_push (t);
+  set_status (t, THREAD_READY);
+  latency_wakeup (t);
+  intr_set_level (old_level);
+
+  thread_preempt ();
 }
 
 /* Returns the name of the running thread. */
@@ -305,12 +524,22 @@ thread_exit (void)
 #ifdef USERPROG
   process_exit ();
 #endif
+  fpu_release (thread_current ());
+  all_list_remove (thread_current ());
 
-  /* Remove thread from all threads list, set our status to dying,
-     and schedule another process.  That process will destroy us
-     when it calls thread_schedule_tail(). */
+  /* Set our status to dying and schedule another process.  That
+     process will destroy us when it calls
+     thread_schedule_tail(). */
   intr_disable ();
-  list_remove (&thread_current()->allelem);
+  if (thread_current ()->mlfqs_active)
+    list_remove (&thread_current ()->mlfqs_elem);
+  if (stride_client (thread_current ()))
+    stride_leave (thread_current ());
+  if (thread_current ()->policy == SCHED_DEADLINE)
+    {
+      dl_bandwidth -= thread_current ()->dl_bandwidth;
+      dl_unthrottle (thread_current ());
+    }
   thread_current ()->status = THREAD_DYING;
   schedule ();
   NOT_REACHED ();
@@ -320,6 +549,60 @@ thread_exit (void)
    may be scheduled again immediately at the scheduler's whim. */
 void
 thread_yield (void)
+{
+  yield (true);
+}
+
+/* Like thread_yield(), but for when the current thread is being
+   preempted rather than giving up the CPU of its own accord.
+   Apart from the scheduling statistics, the difference is that
+   while preemption is disabled, nothing happens except that the
+   thread is marked to yield once preemption is enabled again. */
+void
+thread_yield_preempted (void)
+{
+  struct thread *cur = thread_current ();
+
+  if (cur->preempt_count > 0)
+    cur->need_resched = true;
+  else
+    yield (false);
+}
+
+/* Disables preemption of the running thread, which keeps
+   running, interrupts permitting, until it calls
+   preempt_enable() or blocks.  Unlike disabling interrupts,
+   this does not delay interrupt handlers.  Calls nest. */
+void
+preempt_disable (void)
+{
+  ASSERT (!intr_context ());
+
+  thread_current ()->preempt_count++;
+  barrier ();
+}
+
+/* Undoes one preempt_disable().  If that enables preemption,
+   yields if the thread was to be preempted in the meantime. */
+void
+preempt_enable (void)
+{
+  struct thread *cur = thread_current ();
+
+  ASSERT (!intr_context ());
+  ASSERT (cur->preempt_count > 0);
+
+  barrier ();
+  if (--cur->preempt_count == 0)
+    cond_resched ();
+}
+
+/* A preemption point, for long-running kernel loops.  Yields if
+   the running thread was to be preempted while it could not be,
+   or if a thread that should preempt it is ready.  Does nothing
+   if interrupts or preemption are disabled. */
+void
+cond_resched (void)
 {
   struct thread *cur = thread_current ();
   enum intr_level old_level;
@@ -327,35 +610,291 @@ thread_yield (void)
   ASSERT (!intr_context ());
 
   old_level = intr_disable ();
+  if (old_level == INTR_ON && cur->preempt_count == 0
+      && (cur->need_resched || should_preempt (cur)))
+    yield (false);
+  intr_set_level (old_level);
+}
+
+/* Yields the CPU, counting the context switch as VOLUNTARY or
+   not. */
+static void
+yield (bool voluntary)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (!intr_context ());
+
+  old_level = intr_disable ();
+  if (voluntary)
+    cur->stats.voluntary_switches++;
+  else
+    cur->stats.involuntary_switches++;
+  if (cur->dl_throttled)
+    {
+      /* Out of budget: sleep until dl_replenish() wakes us. */
+      cur->dl_parked = true;
+      set_status (cur, THREAD_BLOCKED);
+      schedule ();
+      intr_set_level (old_level);
+      return;
+    }
   if (cur != idle_thread)
-    list_push_back (&ready_list, &cur->elem);
-  cur->status = THREAD_READY;
+    {
+      /* A preempted SCHED_FIFO thread keeps its place at the head
+         of its ready list. */
+      if (!voluntary && cur->policy == SCHED_FIFO)
+        ready_push_front (cur);
+      else
+        ready_push (cur);
+    }
+  set_status (cur, THREAD_READY);
   schedule ();
   intr_set_level (old_level);
 }
 
 /* Invoke function 'func' on all threads, passing along 'aux'.
-   This function must be called with interrupts off. */
+   From thread context with interrupts on, holds all_lock for
+   reading while walking, so FUNC may sleep but must not create
+   or exit threads.  Otherwise, interrupts keep the list stable. */
 void
 thread_foreach (thread_action_func *func, void *aux)
 {
   struct list_elem *e;
+  bool locked = !intr_context () && intr_get_level () == INTR_ON;
 
-  ASSERT (intr_get_level () == INTR_OFF);
-
+  if (locked)
+    rwlock_acquire_read (&all_lock);
   for (e = list_begin (&all_list); e != list_end (&all_list);
        e = list_next (e))
     {
       struct thread *t = list_entry (e, struct thread, allelem);
       func (t, aux);
     }
+  if (locked)
+    rwlock_release_read (&all_lock);
 }
 
-/* Sets the current thread's priority to NEW_PRIORITY. */
+/* Yields the CPU if a thread with a higher priority than the
+   running thread is ready to run, or, if the running thread is a
+   SCHED_DEADLINE thread, one with an earlier deadline.
+
+   Within an external interrupt handler, the yield is deferred
+   until the handler returns.  Otherwise, if interrupts are
+   turned off, the caller may be relying on them being off for
+   atomicity, so the yield is put off until the thread reaches a
+   preemption point (see cond_resched()) or the next timer tick,
+   whichever comes first.  Callers may also call this function
+   again once they turn interrupts back on.  While preemption is
+   disabled, the yield waits for preempt_enable(). */
+void
+thread_preempt (void)
+{
+  enum intr_level old_level = intr_disable ();
+
+  if (should_preempt (thread_current ()))
+    {
+      if (intr_context ())
+        intr_yield_on_return ();
+      else if (old_level == INTR_ON)
+        thread_yield_preempted ();
+      else
+        thread_current ()->need_resched = true;
+    }
+  intr_set_level (old_level);
+}
+
+/* Sets the current thread's base priority to NEW_PRIORITY.  The
+   thread keeps running at any higher priority donated to it
+   until the donations are withdrawn.  Yields if the current
+   thread no longer has the highest priority.  Ignored under the
+   multi-level feedback queue and stride schedulers, which do not
+   use priorities set this way.  A real-time thread keeps its
+   real-time priority; NEW_PRIORITY takes effect if it returns
+   to SCHED_OTHER. */
 void
 thread_set_priority (int new_priority)
 {
-  thread_current ()->priority = new_priority;
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (PRI_MIN <= new_priority && new_priority <= PRI_MAX);
+
+  if (thread_mlfqs || thread_stride)
+    return;
+
+  old_level = intr_disable ();
+  cur->base_priority = new_priority;
+  thread_update_priority (cur);
+  intr_set_level (old_level);
+
+  thread_preempt ();
+}
+
+/* Propagates the priority of DONOR, which is about to wait for
+   DONOR->waiting_lock, to the lock's holder, and from there
+   along the chain of holders that are themselves waiting for
+   locks, up to DONATION_DEPTH_MAX links.  Stops early at the
+   first holder that already has at least the donated priority.
+   Interrupts must be off. */
+void
+thread_donate_priority (struct thread *donor)
+{
+  int depth;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (!thread_mlfqs && !thread_stride);
+
+  for (depth = 0; depth < DONATION_DEPTH_MAX; depth++)
+    {
+      struct thread *holder;
+
+      if (donor->waiting_lock == NULL)
+        break;
+      holder = donor->waiting_lock->holder;
+      if (holder == NULL || holder->priority >= donor->priority)
+        break;
+
+      change_priority (holder, donor->priority);
+      donor = holder;
+    }
+}
+
+/* Recomputes T's priority as the maximum of its own priority
+   and the priorities of the threads donating to it.  Interrupts
+   must be off.  Does not preempt the running thread. */
+void
+thread_update_priority (struct thread *t)
+{
+  int priority = own_priority (t);
+  struct list_elem *e;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (e = list_begin (&t->donors); e != list_end (&t->donors);
+       e = list_next (e))
+    {
+      struct thread *donor = list_entry (e, struct thread, donor_elem);
+      if (donor->priority > priority)
+        priority = donor->priority;
+    }
+  change_priority (t, priority);
+}
+
+/* Puts the current thread in scheduling POLICY.  For SCHED_FIFO
+   and SCHED_RR, RT_PRIORITY is the real-time priority, between
+   SCHED_RT_PRI_MIN and SCHED_RT_PRI_MAX; for SCHED_OTHER it must
+   be 0.  QUANTUM is the time slice in timer ticks, or 0 for the
+   default.  It matters only to SCHED_RR and SCHED_OTHER threads.
+   Returns true if successful, false if an argument is invalid.
+
+   Real-time threads always run ahead of normal threads, whether
+   the latter are scheduled by priority or by the multi-level
+   feedback queue scheduler.  Yields if the current thread no
+   longer has the highest priority. */
+bool
+thread_set_policy (int policy, int rt_priority, int quantum)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  if (policy == SCHED_OTHER)
+    {
+      if (rt_priority != 0)
+        return false;
+    }
+  else if (policy == SCHED_FIFO || policy == SCHED_RR)
+    {
+      if (rt_priority < SCHED_RT_PRI_MIN || rt_priority > SCHED_RT_PRI_MAX)
+        return false;
+    }
+  else
+    return false;
+  if (quantum < 0)
+    return false;
+
+  old_level = intr_disable ();
+  if (stride_client (cur))
+    stride_leave (cur);
+  if (cur->policy == SCHED_DEADLINE)
+    {
+      dl_bandwidth -= cur->dl_bandwidth;
+      dl_unthrottle (cur);
+    }
+  cur->policy = policy;
+  cur->rt_priority = rt_priority;
+  cur->quantum = quantum > 0 ? quantum : TIME_SLICE;
+  if (stride_client (cur))
+    stride_join (cur);
+  if (thread_mlfqs && policy == SCHED_OTHER)
+    change_priority (cur, mlfqs_priority (cur));
+  else
+    thread_update_priority (cur);
+  intr_set_level (old_level);
+
+  thread_preempt ();
+  return true;
+}
+
+/* Makes the current thread a SCHED_DEADLINE thread that needs
+   RUNTIME ticks of CPU time in every PERIOD ticks, within
+   DEADLINE ticks of the start of the period, where 0 < RUNTIME
+   <= DEADLINE <= PERIOD.
+
+   SCHED_DEADLINE threads run ahead of all others, earliest
+   absolute deadline first.  A thread that uses up its RUNTIME is
+   throttled until its next period begins.  The combined
+   bandwidth (RUNTIME / PERIOD) of all SCHED_DEADLINE threads is
+   limited to DL_BANDWIDTH_MAX, so that they can all meet their
+   deadlines and still leave time for other threads.
+
+   Returns true if successful, false if the arguments are invalid
+   or the thread's bandwidth cannot be admitted.  The thread's
+   first period starts now.  Use thread_set_policy() to leave
+   SCHED_DEADLINE. */
+bool
+thread_set_deadline (int64_t runtime, int64_t period, int64_t deadline)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+  fixed_t bandwidth, available;
+
+  if (runtime <= 0 || runtime > deadline || deadline > period
+      || period > INT32_MAX / FP_ONE)
+    return false;
+  bandwidth = fp_div (fp_from_int (runtime), fp_from_int (period));
+
+  old_level = intr_disable ();
+  available = DL_BANDWIDTH_MAX - dl_bandwidth;
+  if (cur->policy == SCHED_DEADLINE)
+    available += cur->dl_bandwidth;
+  if (bandwidth > available)
+    {
+      intr_set_level (old_level);
+      return false;
+    }
+
+  if (stride_client (cur))
+    stride_leave (cur);
+  if (cur->policy == SCHED_DEADLINE)
+    {
+      dl_bandwidth -= cur->dl_bandwidth;
+      dl_unthrottle (cur);
+    }
+  dl_bandwidth += bandwidth;
+  cur->policy = SCHED_DEADLINE;
+  cur->rt_priority = 0;
+  cur->dl_runtime = runtime;
+  cur->dl_deadline = deadline;
+  cur->dl_period = period;
+  cur->dl_bandwidth = bandwidth;
+  dl_new_period (cur, timer_ticks ());
+  thread_update_priority (cur);
+  intr_set_level (old_level);
+
+  thread_preempt ();
+  return true;
 }
 
 /* Returns the current thread's priority. */
@@ -365,34 +904,328 @@ thread_get_priority (void)
   return thread_current ()->priority;
 }
 
-/* Sets the current thread's nice value to NICE. */
+/* Sets the current thread's nice value to NICE and recomputes
+   its priority.  Yields if the current thread no longer has the
+   highest priority. */
+void
+thread_set_nice (int nice)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (NICE_MIN <= nice && nice <= NICE_MAX);
+
+  old_level = intr_disable ();
+  cur->nice = nice;
+  if (thread_mlfqs)
+    {
+      mlfqs_track (cur);
+      if (cur->policy == SCHED_OTHER)
+        change_priority (cur, mlfqs_priority (cur));
+    }
+  intr_set_level (old_level);
+
+  thread_preempt ();
+}
+
+/* Returns the current thread's ticket count. */
+int
+thread_get_tickets (void)
+{
+  return thread_current ()->tickets;
+}
+
+/* Sets the current thread's ticket count to TICKETS, which
+   determines its share of the CPU under the stride scheduler.
+   The part of its current stride that it has yet to run is
+   scaled to the new stride, so that the change takes effect
+   immediately. */
 void
-thread_set_nice (int nice UNUSED)
+thread_set_tickets (int tickets)
 {
-  /* Not yet implemented. */
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (TICKETS_MIN <= tickets && tickets <= TICKETS_MAX);
+
+  old_level = intr_disable ();
+  if (stride_client (cur))
+    {
+      stride_leave (cur);
+      cur->remain = cur->remain * cur->tickets / tickets;
+      cur->tickets = tickets;
+      stride_join (cur);
+    }
+  else
+    cur->tickets = tickets;
+  intr_set_level (old_level);
 }
 
 /* Returns the current thread's nice value. */
 int
 thread_get_nice (void)
 {
-  /* Not yet implemented. */
-  return 0;
+  return thread_current ()->nice;
 }
 
 /* Returns 100 times the system load average. */
 int
 thread_get_load_avg (void)
 {
-  /* Not yet implemented. */
-  return 0;
+  enum intr_level old_level = intr_disable ();
+  int load_avg_100 = fp_round (load_avg * 100);
+  intr_set_level (old_level);
+
+  return load_avg_100;
 }
 
+/* Returns 100 times the current thread's recent_cpu value. */
 int
 thread_get_recent_cpu (void) 
 {
-  /* Not yet implemented. */
-  return 0;
+  enum intr_level old_level = intr_disable ();
+  int recent_cpu_100 = fp_round (thread_current ()->recent_cpu * 100);
+  intr_set_level (old_level);
+
+  return recent_cpu_100;
+}
+
+/* Multi-level feedback queue scheduler work done at each timer
+   tick, on behalf of CUR, the running thread.  Runs in an
+   external interrupt context.
+
+   Only the running thread's recent_cpu changes from one tick to
+   the next, so its priority is the only one that needs to be
+   recomputed every fourth tick.  Once per second, the load
+   average and every tracked thread's recent_cpu and priority
+   are recomputed.  Real-time threads are charged for their CPU
+   time like any other, but their priorities are left alone. */
+static void
+mlfqs_tick (struct thread *cur)
+{
+  int64_t now = timer_ticks ();
+
+  ASSERT (intr_context ());
+
+  if (cur != idle_thread)
+    {
+      cur->recent_cpu = fp_add_int (cur->recent_cpu, 1);
+      mlfqs_track (cur);
+    }
+
+  if (now % TIMER_FREQ == 0)
+    {
+      int ready = ready_count + (cur != idle_thread);
+      fixed_t twice_load, decay;
+      struct list_elem *e;
+
+      /* load_avg = (59/60)*load_avg + (1/60)*ready_threads. */
+      load_avg = (load_avg * 59 + fp_from_int (ready)) / 60;
+
+      /* recent_cpu = (2*load_avg)/(2*load_avg + 1)*recent_cpu + nice. */
+      twice_load = load_avg * 2;
+      decay = fp_div (twice_load, fp_add_int (twice_load, 1));
+      for (e = list_begin (&mlfqs_list); e != list_end (&mlfqs_list); )
+        {
+          struct thread *t = list_entry (e, struct thread, mlfqs_elem);
+
+          t->recent_cpu = fp_add_int (fp_mul (decay, t->recent_cpu), t->nice);
+          if (t->policy == SCHED_OTHER)
+            change_priority (t, mlfqs_priority (t));
+          if (t->recent_cpu == 0 && t->nice == 0)
+            {
+              e = list_remove (e);
+              t->mlfqs_active = false;
+            }
+          else
+            e = list_next (e);
+        }
+    }
+  else if (now % 4 == 0 && cur != idle_thread && cur->policy == SCHED_OTHER)
+    change_priority (cur, mlfqs_priority (cur));
+
+  thread_preempt ();
+}
+
+/* Adds T to mlfqs_list, if it is not already there and its
+   recent_cpu or nice value is nonzero. */
+static void
+mlfqs_track (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!t->mlfqs_active && (t->recent_cpu != 0 || t->nice != 0))
+    {
+      list_push_back (&mlfqs_list, &t->mlfqs_elem);
+      t->mlfqs_active = true;
+    }
+}
+
+/* Returns the priority that the multi-level feedback queue
+   scheduler assigns to T:
+   PRI_MAX - (recent_cpu / 4) - (nice * 2), clamped to the range
+   of valid priorities. */
+static int
+mlfqs_priority (const struct thread *t)
+{
+  int priority = PRI_MAX - fp_to_int (t->recent_cpu / 4) - t->nice * 2;
+
+  if (priority < PRI_MIN)
+    return PRI_MIN;
+  else if (priority > PRI_MAX)
+    return PRI_MAX;
+  else
+    return priority;
+}
+
+/* Returns true if T is scheduled by the stride scheduler. */
+static bool
+stride_client (const struct thread *t)
+{
+  return thread_stride && t->policy == SCHED_OTHER && t->tickets > 0;
+}
+
+/* Makes T, which is becoming runnable, compete for the CPU under
+   the stride scheduler. */
+static void
+stride_join (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  global_tickets += t->tickets;
+  t->pass = global_pass + t->remain;
+}
+
+/* Withdraws T, which is blocking or exiting, from competition
+   under the stride scheduler. */
+static void
+stride_leave (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (global_tickets >= t->tickets);
+
+  global_tickets -= t->tickets;
+  t->remain = t->pass - global_pass;
+}
+
+/* Stride scheduler work done at each timer tick on behalf of
+   CUR, the running thread: charges a tick to CUR and to the
+   system as a whole. */
+static void
+stride_tick (struct thread *cur)
+{
+  ASSERT (global_tickets > 0);
+
+  cur->pass += STRIDE1 / cur->tickets;
+  global_pass += STRIDE1 / global_tickets;
+}
+
+/* Starts a new period for SCHED_DEADLINE thread T at tick
+   START, with a full budget. */
+static void
+dl_new_period (struct thread *t, int64_t start)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->policy == SCHED_DEADLINE);
+
+  t->dl_budget = t->dl_runtime;
+  t->dl_abs_deadline = start + t->dl_deadline;
+  t->dl_next_period = start + t->dl_period;
+}
+
+/* SCHED_DEADLINE work done at each timer tick on behalf of CUR,
+   the running thread: starts a new period if one is due, and
+   otherwise charges the tick to CUR's budget, throttling CUR if
+   that runs out. */
+static void
+dl_tick (struct thread *cur)
+{
+  int64_t now = timer_ticks ();
+
+  ASSERT (intr_context ());
+
+  if (now >= cur->dl_next_period)
+    {
+      dl_new_period (cur, now);
+      thread_preempt ();
+    }
+  else if (--cur->dl_budget <= 0 && !cur->dl_throttled)
+    dl_throttle (cur);
+}
+
+/* Throttles CUR, the running SCHED_DEADLINE thread, which has
+   used up its budget, until its next period begins.
+
+   A throttled thread never becomes ready: yield() and
+   thread_unblock() park it instead, as blocked with dl_parked
+   set, and only dl_replenish() unblocks a parked thread.  So the
+   throttle takes effect when CUR next leaves the CPU, whether it
+   is preempted on return from the timer interrupt, later if
+   preemption is disabled, or blocks first; a thread blocked on
+   something else is parked when it is woken. */
+static void
+dl_throttle (struct thread *cur)
+{
+  cur->dl_throttled = true;
+  timer_add (&cur->dl_timer, cur->dl_next_period, dl_replenish, cur);
+  intr_yield_on_return ();
+}
+
+/* Ends any throttling of T, the running thread, which is leaving
+   SCHED_DEADLINE, starting over with new parameters, or exiting.
+   Cancels the pending dl_replenish() so that it cannot run on a
+   thread that is no longer throttled, or whose page has been
+   freed.  Interrupts must be off. */
+static void
+dl_unthrottle (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (!t->dl_parked);
+
+  timer_cancel (&t->dl_timer);
+  t->dl_throttled = false;
+}
+
+/* Timer callback that ends the throttling of the thread T at the
+   start of its next period.  Unblocks T only if the throttle
+   parked it; if T is running, or blocked for some other reason,
+   it is left as it is. */
+static void
+dl_replenish (void *t_)
+{
+  struct thread *t = t_;
+
+  ASSERT (t->dl_throttled);
+
+  t->dl_throttled = false;
+  if (t->dl_parked)
+    {
+      t->dl_parked = false;
+      thread_unblock (t);
+    }
+}
+
+/* Returns true if thread A's absolute deadline is earlier than
+   thread B's. */
+static bool
+deadline_less (const struct heap_elem *a_, const struct heap_elem *b_,
+               void *aux UNUSED)
+{
+  const struct thread *a = heap_entry (a_, struct thread, dl_elem);
+  const struct thread *b = heap_entry (b_, struct thread, dl_elem);
+
+  return a->dl_abs_deadline < b->dl_abs_deadline;
+}
+
+/* Returns true if thread A's pass is less than thread B's. */
+static bool
+pass_less (const struct heap_elem *a_, const struct heap_elem *b_,
+           void *aux UNUSED)
+{
+  const struct thread *a = heap_entry (a_, struct thread, stride_elem);
+  const struct thread *b = heap_entry (b_, struct thread, stride_elem);
+
+  return a->pass < b->pass;
 }
 
 /* Idle thread.  Executes when no other thread is ready to run.
@@ -402,8 +1235,8 @@ thread_get_recent_cpu (void)
    point it initializes idle_thread, "up"s the semaphore passed
    to it to enable thread_start() to continue, and immediately
    blocks.  After that, the idle thread never appears in the
-   ready list.  It is returned by next_thread_to_run() as a
-   special case when the ready list is empty. */
+   ready lists.  It is returned by next_thread_to_run() as a
+   special case when all the ready lists are empty. */
 static void
 idle (void *idle_started_ UNUSED)
 {
@@ -417,6 +1250,11 @@ idle (void *idle_started_ UNUSED)
       intr_disable ();
       thread_block ();
 
+      /* Nothing else to run.  Stop the periodic timer interrupt
+         until the next timer event is due, so that we are not
+         woken up just to go back to sleep. */
+      timer_nohz_enter ();
+
       /* Re-enable interrupts and wait for the next one.
 
          The `sti' instruction disables interrupts until the
@@ -465,6 +1303,32 @@ is_thread (struct thread *t)
   return t != NULL && t->magic == THREAD_MAGIC;
 }
 
+/* Adds T to all_list. */
+static void
+all_list_add (struct thread *t)
+{
+  enum intr_level old_level;
+
+  rwlock_acquire_write (&all_lock);
+  old_level = intr_disable ();
+  list_push_back (&all_list, &t->allelem);
+  intr_set_level (old_level);
+  rwlock_release_write (&all_lock);
+}
+
+/* Removes T from all_list. */
+static void
+all_list_remove (struct thread *t)
+{
+  enum intr_level old_level;
+
+  rwlock_acquire_write (&all_lock);
+  old_level = intr_disable ();
+  list_remove (&t->allelem);
+  intr_set_level (old_level);
+  rwlock_release_write (&all_lock);
+}
+
 /* Does basic initialization of T as a blocked thread named
    NAME. */
 static void
@@ -476,11 +1340,17 @@ init_thread (struct thread *t, const char *name, int priority)
 
   memset (t, 0, sizeof *t);
   t->status = THREAD_BLOCKED;
+  t->state_since = timer_ticks ();
   strlcpy (t->name, name, sizeof t->name);
   t->stack = (uint8_t *) t + PGSIZE;
-  t->priority = priority;
+  t->priority = t->base_priority = priority;
+  list_init (&t->donors);
+  t->policy = SCHED_OTHER;
+  t->quantum = TIME_SLICE;
+  t->tickets = TICKETS_DEFAULT;
+  t->remain = STRIDE1 / TICKETS_DEFAULT;
+  t->nice = NICE_DEFAULT;
   t->magic = THREAD_MAGIC;
-  list_push_back (&all_list, &t->allelem);
 
   //Aggiunto
   /* Inizializzo le strutture dati necessarie per gestire i thread figli e sincronizzare il thread padre con i suoi figli nel sistema operativo. */
@@ -504,6 +1374,195 @@ alloc_frame (struct thread *t, size_t size)
   return t->stack;
 }
 
+/* Adds T to the back of the ready list for its priority, or to
+   stride_heap if it is scheduled by the stride scheduler. */
+static void
+ready_push (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (PRI_MIN <= t->priority && t->priority <= PRI_DL);
+
+  if (stride_client (t))
+    {
+      heap_insert (&stride_heap, &t->stride_elem);
+      ready_count++;
+      return;
+    }
+  if (t->policy == SCHED_DEADLINE)
+    {
+      heap_insert (&dl_heap, &t->dl_elem);
+      ready_count++;
+      return;
+    }
+
+  list_push_back (&ready_lists[t->priority], &t->elem);
+  ready_mask[t->priority / 32] |= 1u << (t->priority % 32);
+  ready_count++;
+}
+
+/* Adds T to the front of the ready list for its priority, so
+   that it runs next among threads of that priority.  T must not
+   be scheduled by the stride scheduler or be a SCHED_DEADLINE
+   thread. */
+static void
+ready_push_front (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (PRI_MIN <= t->priority && t->priority <= PRI_DL);
+  ASSERT (!stride_client (t) && t->policy != SCHED_DEADLINE);
+
+  list_push_front (&ready_lists[t->priority], &t->elem);
+  ready_mask[t->priority / 32] |= 1u << (t->priority % 32);
+  ready_count++;
+}
+
+/* Removes T, which must be in the ready state, from its ready
+   list, from stride_heap, or from dl_heap. */
+static void
+ready_remove (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->status == THREAD_READY);
+
+  if (stride_client (t))
+    {
+      heap_remove (&stride_heap, &t->stride_elem);
+      ready_count--;
+      return;
+    }
+  if (t->policy == SCHED_DEADLINE)
+    {
+      heap_remove (&dl_heap, &t->dl_elem);
+      ready_count--;
+      return;
+    }
+
+  list_remove (&t->elem);
+  if (list_empty (&ready_lists[t->priority]))
+    ready_mask[t->priority / 32] &= ~(1u << (t->priority % 32));
+  ready_count--;
+}
+
+/* Returns the highest priority of a thread that is ready to run,
+   or -1 if no thread is ready to run. */
+static int
+ready_max_priority (void)
+{
+  int i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!heap_empty (&dl_heap))
+    return PRI_DL;
+
+  for (i = READY_MASK_WORDS - 1; i >= 0; i--)
+    if (ready_mask[i] != 0)
+      {
+        uint32_t bit;
+        asm ("bsrl %1, %0" : "=r" (bit) : "rm" (ready_mask[i]));
+        if (i * 32 + (int) bit >= PRI_RT_MIN || heap_empty (&stride_heap))
+          return i * 32 + bit;
+        break;
+      }
+
+  /* All stride threads have priority PRI_DEFAULT. */
+  return heap_empty (&stride_heap) ? -1 : PRI_DEFAULT;
+}
+
+/* Removes and returns the thread at the front of the
+   highest-priority nonempty ready list, or a null pointer if no
+   thread is ready to run.  The SCHED_DEADLINE thread with the
+   earliest deadline stands in for priority PRI_DL, after any
+   threads that were donated that priority, and under the stride
+   scheduler, the stride thread with the smallest pass stands in
+   for all normal priorities. */
+static struct thread *
+ready_pop (void)
+{
+  int pri = ready_max_priority ();
+  struct thread *t;
+
+  if (pri < 0)
+    return NULL;
+
+  if (pri == PRI_DL && list_empty (&ready_lists[PRI_DL]))
+    {
+      t = heap_entry (heap_pop_min (&dl_heap), struct thread, dl_elem);
+      ready_count--;
+      return t;
+    }
+  if (pri < PRI_RT_MIN && !heap_empty (&stride_heap))
+    {
+      t = heap_entry (heap_pop_min (&stride_heap), struct thread,
+                      stride_elem);
+      ready_count--;
+      return t;
+    }
+
+  t = list_entry (list_front (&ready_lists[pri]), struct thread, elem);
+  ready_remove (t);
+  return t;
+}
+
+/* Sets T's priority to PRIORITY, moving T to the matching ready
+   list if it is ready to run, or requeuing it among the waiters
+   of the semaphore or condition variable it is waiting for.
+   Does not preempt the running thread. */
+static void
+change_priority (struct thread *t, int priority)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (PRI_MIN <= priority && priority <= PRI_DL);
+
+  if (t->priority == priority)
+    return;
+
+  if (t->status == THREAD_READY)
+    {
+      ready_remove (t);
+      t->priority = priority;
+      ready_push (t);
+    }
+  else
+    synch_change_priority (t, priority);
+}
+
+/* Returns T's priority before donations: PRI_DL for a
+   SCHED_DEADLINE thread, its real-time priority for SCHED_FIFO
+   and SCHED_RR threads, otherwise its base priority. */
+static int
+own_priority (const struct thread *t)
+{
+  if (t->policy == SCHED_OTHER)
+    return t->base_priority;
+  else if (t->policy == SCHED_DEADLINE)
+    return PRI_DL;
+  else
+    return PRI_RT_MIN + t->rt_priority;
+}
+
+/* Returns true if a thread that is ready to run should preempt
+   CUR, the running thread: either it has a higher priority, or
+   both are SCHED_DEADLINE threads and it has an earlier
+   deadline. */
+static bool
+should_preempt (struct thread *cur)
+{
+  int pri = ready_max_priority ();
+
+  if (pri > cur->priority)
+    return true;
+  else if (pri == PRI_DL && cur->policy == SCHED_DEADLINE
+           && list_empty (&ready_lists[PRI_DL]))
+    {
+      struct thread *t = heap_entry (heap_min (&dl_heap), struct thread,
+                                     dl_elem);
+      return t->dl_abs_deadline < cur->dl_abs_deadline;
+    }
+  else
+    return false;
+}
+
 /* Chooses and returns the next thread to be scheduled.  Should
    return a thread from the run queue, unless the run queue is
    empty.  (If the running thread can continue running, then it
@@ -512,13 +1571,8 @@ alloc_frame (struct thread *t, size_t size)
 static struct thread *
 next_thread_to_run (void)
 {
-  if (list_empty (&ready_list))
-    return idle_thread;
-  else
-  {
-    return list_entry (list_pop_back (&ready_list), struct thread, elem);
-  }
-
+  struct thread *t = ready_pop ();
+  return t != NULL ? t : idle_thread;
 }
 
 /* Completes a thread switch by activating the new thread's page
@@ -545,7 +1599,12 @@ thread_schedule_tail (struct thread *prev)
   ASSERT (intr_get_level () == INTR_OFF);
 
   /* Mark us as running. */
-  cur->status = THREAD_RUNNING;
+  set_status (cur, THREAD_RUNNING);
+  cur->stats.last_run = cur->state_since;
+  latency_run (cur, prev);
+
+  /* Let the FPU trap unless we own it. */
+  fpu_switch (cur);
 
   /* Start new time slice. */
   thread_ticks = 0;
@@ -563,8 +1622,88 @@ thread_schedule_tail (struct thread *prev)
   if (prev != NULL && prev->status == THREAD_DYING && prev != initial_thread)
     {
       ASSERT (prev != cur);
-      palloc_free_page (prev);
+      thread_page_free (prev);
+    }
+}
+
+/* Returns a page for a new thread, recycling one from
+   thread_cache if possible, or a null pointer if none is
+   available.  Only the `struct thread' at the bottom of the page
+   is guaranteed to be zeroed. */
+static struct thread *
+thread_page_get (void)
+{
+  enum intr_level old_level;
+  struct thread *t;
+
+  old_level = intr_disable ();
+  t = thread_cache;
+  if (t != NULL)
+    {
+      thread_cache = *(void **) t;
+      thread_cache_cnt--;
+    }
+  intr_set_level (old_level);
+
+  if (t == NULL)
+    return palloc_get_page (PAL_ZERO);
+  memset (t, 0, sizeof *t);
+  return t;
+}
+
+/* Frees the page of dead thread T, by adding it to thread_cache
+   unless the cache is full.  Otherwise the page goes back to the
+   page allocator, but from system_wq: palloc_free_page() takes a
+   lock, and so may sleep, which thread_schedule_tail() must not
+   do.  The work item lives in the dead page itself. */
+static void
+thread_page_free (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  /* Clearing `magic' makes is_thread() reject stale pointers to
+     T, as poisoning the page in palloc_free_page() would have. */
+  t->magic = 0;
+  if (thread_cache_cnt < THREAD_CACHE_MAX)
+    {
+      *(void **) t = thread_cache;
+      thread_cache = t;
+      thread_cache_cnt++;
+    }
+  else if (system_wq != NULL)
+    {
+      struct work *work = (struct work *) t;
+
+      work_init (work, thread_page_reap);
+      queue_work (system_wq, work);
     }
+  else
+    palloc_free_page (t);
+}
+
+/* Returns the dead thread page that holds WORK to the page
+   allocator.  Runs in a system_wq worker. */
+static void
+thread_page_reap (struct work *work)
+{
+  palloc_free_page (work);
+}
+
+/* Sets T's status to STATUS, charging the time spent in its old
+   status to its scheduling statistics. */
+static void
+set_status (struct thread *t, enum thread_status status)
+{
+  int64_t now = timer_ticks ();
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (t->status == THREAD_READY)
+    t->stats.ready_ticks += now - t->state_since;
+  else if (t->status == THREAD_BLOCKED)
+    t->stats.blocked_ticks += now - t->state_since;
+  t->status = status;
+  t->state_since = now;
 }
 
 /* Schedules a new process.  At entry, interrupts must be off and
@@ -585,6 +1724,7 @@ schedule (void)
   ASSERT (cur->status != THREAD_RUNNING);
   ASSERT (is_thread (next));
 
+  cur->need_resched = false;
   if (cur != next)
     prev = switch_threads (cur, next);
   thread_schedule_tail (prev);
@@ -2,8 +2,13 @@
 #define THREADS_THREAD_H
 
 #include <debug.h>
+#include <heap.h>
 #include <list.h>
+#include <sched.h>
 #include <stdint.h>
+#include "devices/timer.h"
+#include "threads/fixed-point.h"
+#include "threads/latency.h"
 #include "synch.h" //Aggiunto
 
 /* States in a thread's life cycle. */
@@ -25,6 +30,31 @@ typedef int tid_t;
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
 
+/* Scheduling priorities of real-time threads, which lie above
+   all normal priorities.  A SCHED_FIFO or SCHED_RR thread with
+   real-time priority P is scheduled at PRI_RT_MIN + P. */
+#define PRI_RT_MIN (PRI_MAX + 1)
+#define PRI_RT_MAX (PRI_RT_MIN + SCHED_RT_PRI_MAX)
+
+/* Scheduling priority of SCHED_DEADLINE threads, above all
+   others.  Among themselves they run earliest deadline first. */
+#define PRI_DL (PRI_RT_MAX + 1)
+
+/* Maximum length of a chain of priority donations through
+   nested locks. */
+#define DONATION_DEPTH_MAX 8
+
+/* Thread nice values, for the multi-level feedback queue
+   scheduler. */
+#define NICE_MIN -20                    /* Nicest to other threads. */
+#define NICE_DEFAULT 0                  /* Default nice value. */
+#define NICE_MAX 20                     /* Least nice to others. */
+
+/* Thread ticket counts, for the stride scheduler. */
+#define TICKETS_MIN 1                   /* Smallest share. */
+#define TICKETS_DEFAULT 100             /* Default share. */
+#define TICKETS_MAX 10000               /* Largest share. */
+
 /* A kernel thread or user process.
 
    Each thread structure is stored in its own 4 kB page.  The
@@ -75,12 +105,10 @@ typedef int tid_t;
    the `magic' member of the running thread's `struct thread' is
    set to THREAD_MAGIC.  Stack overflow will normally change this
    value, triggering the assertion. */
-/* The `elem' member has a dual purpose.  It can be an element in
-   the run queue (thread.c), or it can be an element in a
-   semaphore wait list (synch.c).  It can be used these two ways
-   only because they are mutually exclusive: only a thread in the
-   ready state is on the run queue, whereas only a thread in the
-   blocked state is on a semaphore wait list. */
+/* The `elem' member is an element in the run queue (thread.c).
+   A thread waiting for a semaphore is in the semaphore's waiter
+   heap through `wait_elem' instead (synch.c), so that it can be
+   requeued there if its priority changes while it waits. */
 struct thread
   {
     /* Owned by thread.c. */
@@ -88,15 +116,73 @@ struct thread
     enum thread_status status;          /* Thread state. */
     char name[16];                      /* Name (for debugging purposes). */
     uint8_t *stack;                     /* Saved stack pointer. */
-    int priority;                       /* Priority. */
+    int priority;                       /* Scheduling priority, including
+                                           donations. */
     struct list_elem allelem;           /* List element for all threads list. */
 
     /* Shared between thread.c and synch.c. */
     struct list_elem elem;              /* List element. */
+    struct semaphore *waiting_sema;     /* Semaphore being waited for. */
+    struct heap_elem wait_elem;         /* Heap element for its waiters. */
+    unsigned wait_seq;                  /* Order of arrival among waiters. */
+    struct semaphore_elem *cond_waiter; /* Waiter in a condition, if any. */
+
+    /* Priority donation, shared between thread.c and synch.c. */
+    int base_priority;                  /* Priority before donations. */
+    struct lock *waiting_lock;          /* Lock being waited for, if any. */
+    struct list donors;                 /* Threads donating to this one. */
+    struct list_elem donor_elem;        /* List element for donors list. */
+
+    /* Owned by thread.c, for kernel preemption. */
+    int preempt_count;                  /* Nesting of preempt_disable(). */
+    bool need_resched;                  /* Yield at next preemption point? */
+
+    /* Owned by thread.c, for real-time scheduling. */
+    int policy;                         /* SCHED_* policy. */
+    int rt_priority;                    /* Real-time priority. */
+    unsigned quantum;                   /* Time slice, in timer ticks. */
+
+    /* Owned by thread.c, for scheduling statistics. */
+    struct schedstat stats;             /* Statistics so far. */
+    int64_t state_since;                /* When status last changed. */
+
+    /* Owned by latency.c. */
+    struct latency_thread latency;      /* Wakeup latency tracing. */
+
+    /* Owned by thread.c, for the multi-level feedback queue
+       scheduler. */
+    int nice;                           /* Niceness. */
+    fixed_t recent_cpu;                 /* Recent CPU time received. */
+    bool mlfqs_active;                  /* In mlfqs_list? */
+    struct list_elem mlfqs_elem;        /* List element for mlfqs_list. */
+
+    /* Owned by thread.c, for SCHED_DEADLINE.  Times are in timer
+       ticks. */
+    int64_t dl_runtime;                 /* Budget per period. */
+    int64_t dl_deadline;                /* Relative deadline. */
+    int64_t dl_period;                  /* Period. */
+    fixed_t dl_bandwidth;               /* dl_runtime / dl_period. */
+    int64_t dl_budget;                  /* Budget left in this period. */
+    int64_t dl_abs_deadline;            /* Deadline of this period. */
+    int64_t dl_next_period;             /* Start of next period. */
+    bool dl_throttled;                  /* Out of budget until then? */
+    bool dl_parked;                     /* Blocked until then by throttle? */
+    struct timer_event dl_timer;        /* Replenishes the budget. */
+    struct heap_elem dl_elem;           /* Heap element for dl_heap. */
+
+    /* Owned by thread.c, for the stride scheduler. */
+    int tickets;                        /* Share of the CPU. */
+    int64_t pass;                       /* Virtual time of next run. */
+    int64_t remain;                     /* Pass left over while blocked. */
+    struct heap_elem stride_elem;       /* Heap element for stride_heap. */
+
+    /* Owned by threads/fpu.c. */
+    void *fpu;                          /* FPU save area, or null. */
 
 #ifdef USERPROG
     /* Owned by userprog/process.c. */
     uint32_t *pagedir;                  /* Page directory. */
+    struct sysstat *sysstat;            /* System call counts, or null. */
 #endif
 
 //Aggiunto
@@ -141,11 +227,17 @@ struct thread
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* If true, schedule SCHED_OTHER threads by stride scheduling.
+   Controlled by kernel command-line option "-stride". */
+extern bool thread_stride;
+
 void thread_init (void);
 void thread_start (void);
 
 void thread_tick (void);
 void thread_print_stats (void);
+void thread_print_schedstats (void);
+void thread_get_schedstat (struct thread *, struct schedstat *);
 
 typedef void thread_func (void *aux);
 tid_t thread_create (const char *name, int priority, thread_func *, void *);
@@ -159,6 +251,12 @@ const char *thread_name (void);
 
 void thread_exit (void) NO_RETURN;
 void thread_yield (void);
+void thread_yield_preempted (void);
+void thread_preempt (void);
+
+void preempt_disable (void);
+void preempt_enable (void);
+void cond_resched (void);
 
 /* Performs some operation on thread t, given auxiliary data AUX. */
 typedef void thread_action_func (struct thread *t, void *aux);
@@ -166,6 +264,14 @@ void thread_foreach (thread_action_func *, void *);
 
 int thread_get_priority (void);
 void thread_set_priority (int);
+void thread_donate_priority (struct thread *);
+void thread_update_priority (struct thread *);
+
+bool thread_set_policy (int policy, int rt_priority, int quantum);
+bool thread_set_deadline (int64_t runtime, int64_t period, int64_t deadline);
+
+int thread_get_tickets (void);
+void thread_set_tickets (int);
 
 int thread_get_nice (void);
 void thread_set_nice (int);
@@ -0,0 +1,266 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Maximum number of worker threads per workqueue. */
+#define WORKERS_MAX 4
+
+/* A worker thread. */
+struct worker
+  {
+    struct workqueue *wq;       /* Workqueue it serves. */
+    struct work *current;       /* Work item it is running, if any. */
+  };
+
+/* A workqueue.
+
+   The queue and the `pending' members of the work items on it
+   are protected by disabling interrupts, because work may be
+   queued from interrupt context.  The `current' members of the
+   workers are changed with interrupts off and also, when a work
+   item finishes, with LOCK held, so that flush_work() can wait
+   on DONE without missing a wakeup. */
+struct workqueue
+  {
+    const char *name;           /* Name, for worker threads. */
+    struct list queue;          /* Pending work items. */
+    struct semaphore ready;     /* Number of items in QUEUE. */
+    struct lock lock;           /* Protects DONE. */
+    struct condition done;      /* Signaled when an item finishes. */
+    int worker_cnt;             /* Number of workers. */
+    struct worker workers[WORKERS_MAX]; /* Workers. */
+  };
+
+struct workqueue *system_wq;
+
+static thread_func worker_thread NO_RETURN;
+static void insert_work (struct workqueue *, struct work *);
+static void delayed_work_timer (void *dwork_);
+static bool work_running (struct workqueue *, struct work *);
+
+/* Creates the system workqueue.  Must be called after the
+   thread system has been started. */
+void
+workqueue_init (void) 
+{
+  system_wq = workqueue_create ("events", 2, PRI_DEFAULT);
+  if (system_wq == NULL)
+    PANIC ("could not create system workqueue");
+}
+
+/* Creates and returns a new workqueue named NAME with WORKERS
+   worker threads, which run at PRIORITY.  Returns a null
+   pointer if memory is not available.  Workqueues are never
+   destroyed. */
+struct workqueue *
+workqueue_create (const char *name, int workers, int priority) 
+{
+  struct workqueue *wq;
+  int i;
+
+  ASSERT (name != NULL);
+  ASSERT (workers > 0 && workers <= WORKERS_MAX);
+  ASSERT (priority >= PRI_MIN && priority <= PRI_MAX);
+
+  wq = malloc (sizeof *wq);
+  if (wq == NULL)
+    return NULL;
+  wq->name = name;
+  list_init (&wq->queue);
+  sema_init (&wq->ready, 0);
+  lock_init (&wq->lock);
+  cond_init (&wq->done);
+  wq->worker_cnt = workers;
+  for (i = 0; i < workers; i++)
+    {
+      struct worker *w = &wq->workers[i];
+      char thread_name[16];
+
+      w->wq = wq;
+      w->current = NULL;
+      snprintf (thread_name, sizeof thread_name, "%s/%d", name, i);
+      if (thread_create (thread_name, priority, worker_thread, w)
+          == TID_ERROR)
+        PANIC ("could not create worker thread %s", thread_name);
+    }
+  return wq;
+}
+
+/* Initializes WORK to call FUNC when it runs. */
+void
+work_init (struct work *work, work_func *func) 
+{
+  ASSERT (work != NULL);
+  ASSERT (func != NULL);
+
+  work->func = func;
+  work->wq = NULL;
+  work->pending = false;
+}
+
+/* Initializes DWORK to call FUNC when it runs. */
+void
+delayed_work_init (struct delayed_work *dwork, work_func *func) 
+{
+  work_init (&dwork->work, func);
+  dwork->timer.pending = false;
+}
+
+/* Queues WORK on WQ, to be run by one of its workers.  Returns
+   true if successful, false if WORK was already pending, in
+   which case it is left as it is.  May be called from an
+   interrupt handler. */
+bool
+queue_work (struct workqueue *wq, struct work *work) 
+{
+  enum intr_level old_level;
+  bool queued = false;
+
+  ASSERT (wq != NULL);
+  ASSERT (work != NULL);
+
+  old_level = intr_disable ();
+  if (!work->pending)
+    {
+      work->pending = true;
+      insert_work (wq, work);
+      queued = true;
+    }
+  intr_set_level (old_level);
+  return queued;
+}
+
+/* Queues DWORK on WQ after DELAY timer ticks.  A DELAY of 0 or
+   less queues it immediately.  Returns true if successful, false
+   if DWORK was already pending, either waiting for its delay or
+   in the queue.  May be called from an interrupt handler. */
+bool
+queue_delayed_work (struct workqueue *wq, struct delayed_work *dwork,
+                    int64_t delay) 
+{
+  enum intr_level old_level;
+  bool queued = false;
+
+  ASSERT (wq != NULL);
+  ASSERT (dwork != NULL);
+
+  old_level = intr_disable ();
+  if (!dwork->work.pending)
+    {
+      dwork->work.pending = true;
+      dwork->work.wq = wq;
+      if (delay > 0)
+        timer_add (&dwork->timer, timer_ticks () + delay,
+                   delayed_work_timer, dwork);
+      else
+        insert_work (wq, &dwork->work);
+      queued = true;
+    }
+  intr_set_level (old_level);
+  return queued;
+}
+
+/* Waits until WORK is neither pending nor running.  Work queued
+   again while we wait is waited for too. */
+void
+flush_work (struct work *work) 
+{
+  struct workqueue *wq = work->wq;
+  enum intr_level old_level;
+
+  ASSERT (!intr_context ());
+
+  if (wq == NULL)
+    return;
+
+  lock_acquire (&wq->lock);
+  for (;;)
+    {
+      bool busy;
+
+      old_level = intr_disable ();
+      busy = work->pending || work_running (wq, work);
+      intr_set_level (old_level);
+      if (!busy)
+        break;
+      cond_wait (&wq->done, &wq->lock);
+    }
+  lock_release (&wq->lock);
+}
+
+/* Adds WORK, which must already be marked pending, to WQ's queue
+   and wakes up a worker.  Interrupts must be off. */
+static void
+insert_work (struct workqueue *wq, struct work *work) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (work->pending);
+
+  work->wq = wq;
+  list_push_back (&wq->queue, &work->elem);
+  sema_up (&wq->ready);
+}
+
+/* Timer callback that queues a delayed work item once its delay
+   has passed. */
+static void
+delayed_work_timer (void *dwork_) 
+{
+  struct delayed_work *dwork = dwork_;
+
+  insert_work (dwork->work.wq, &dwork->work);
+}
+
+/* Returns true if one of WQ's workers is running WORK.
+   Interrupts must be off. */
+static bool
+work_running (struct workqueue *wq, struct work *work) 
+{
+  int i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (i = 0; i < wq->worker_cnt; i++)
+    if (wq->workers[i].current == work)
+      return true;
+  return false;
+}
+
+/* A worker thread.  Runs work items from its workqueue, one at
+   a time, forever. */
+static void
+worker_thread (void *worker_) 
+{
+  struct worker *w = worker_;
+  struct workqueue *wq = w->wq;
+
+  for (;;) 
+    {
+      enum intr_level old_level;
+      struct work *work;
+
+      sema_down (&wq->ready);
+
+      /* Take the item off the queue.  Once it is no longer
+         pending it may be queued again, even while it runs. */
+      old_level = intr_disable ();
+      work = list_entry (list_pop_front (&wq->queue), struct work, elem);
+      work->pending = false;
+      w->current = work;
+      intr_set_level (old_level);
+
+      work->func (work);
+
+      /* WORK may have been freed by now, so don't touch it. */
+      lock_acquire (&wq->lock);
+      old_level = intr_disable ();
+      w->current = NULL;
+      intr_set_level (old_level);
+      cond_broadcast (&wq->done, &wq->lock);
+      lock_release (&wq->lock);
+    }
+}
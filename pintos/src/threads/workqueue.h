@@ -0,0 +1,64 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "devices/timer.h"
+
+/* Workqueues.
+
+   A workqueue runs deferred work in a small pool of kernel
+   worker threads, so that code that must not sleep, such as an
+   interrupt handler, can hand off work that may sleep or that is
+   too slow to do with interrupts off.
+
+   A work item is queued with queue_work(), or with
+   queue_delayed_work() to run after a delay, and may be queued
+   from interrupt context.  Queueing an item that is already
+   pending does nothing, so that a burst of requests for the
+   same work is handled by running it once. */
+
+struct work;
+struct workqueue;
+
+/* Function that does the work for a work item.  Runs in a
+   worker thread, so it may sleep.  It may free the work item or
+   queue it again. */
+typedef void work_func (struct work *);
+
+/* A work item.  The caller owns the storage, which must stay
+   valid while the item is pending.  Embed it in a larger
+   structure and use list_entry() style pointer arithmetic to
+   get back to it from the work function. */
+struct work
+  {
+    struct list_elem elem;      /* Element in workqueue's queue. */
+    work_func *func;            /* Function to call. */
+    struct workqueue *wq;       /* Queue it was last queued on. */
+    bool pending;               /* Queued and not yet started? */
+  };
+
+/* A work item that is queued after a delay. */
+struct delayed_work
+  {
+    struct work work;           /* The work item. */
+    struct timer_event timer;   /* Queues the work item. */
+  };
+
+/* Default workqueue, for work that has no particular latency
+   requirements. */
+extern struct workqueue *system_wq;
+
+void workqueue_init (void);
+struct workqueue *workqueue_create (const char *name, int workers,
+                                    int priority);
+
+void work_init (struct work *, work_func *);
+void delayed_work_init (struct delayed_work *, work_func *);
+bool queue_work (struct workqueue *, struct work *);
+bool queue_delayed_work (struct workqueue *, struct delayed_work *,
+                         int64_t delay);
+void flush_work (struct work *);
+
+#endif /* threads/workqueue.h */
@@ -2,13 +2,17 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include "userprog/gdt.h"
+#include "threads/fpu.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/uaccess.h"
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
 
 static void kill (struct intr_frame *);
+static void device_not_available (struct intr_frame *);
 static void page_fault (struct intr_frame *);
 
 /* Registers handlers for interrupts that can be caused by user
@@ -45,7 +49,7 @@ exception_init (void)
   intr_register_int (0, 0, INTR_ON, kill, "#DE Divide Error");
   intr_register_int (1, 0, INTR_ON, kill, "#DB Debug Exception");
   intr_register_int (6, 0, INTR_ON, kill, "#UD Invalid Opcode Exception");
-  intr_register_int (7, 0, INTR_ON, kill,
+  intr_register_int (7, 0, INTR_ON, device_not_available,
                      "#NM Device Not Available Exception");
   intr_register_int (11, 0, INTR_ON, kill, "#NP Segment Not Present");
   intr_register_int (12, 0, INTR_ON, kill, "#SS Stack Fault Exception");
@@ -108,6 +112,18 @@ kill (struct intr_frame *f)
     }
 }
 
+/* #NM handler.  A thread that does not own the FPU tried to use
+   it (see threads/fpu.h), so give it the FPU, loaded with its own
+   state, and let it retry the instruction.  If there is no
+   memory for its save area, treat it like any other
+   exception. */
+static void
+device_not_available (struct intr_frame *f) 
+{
+  if (!fpu_claim ())
+    kill (f);
+}
+
 /* Page fault handler.  This is a skeleton that must be filled in
    to implement virtual memory.  Some solutions to project 2 may
    also require modifying this code.
@@ -148,6 +164,13 @@ page_fault (struct intr_frame *f)
   write = (f->error_code & PF_W) != 0;
   user = (f->error_code & PF_U) != 0;
 
+  /* A kernel fault on a user address, at one of the user memory
+     accesses in userprog/uaccess.c, means that a system call was
+     passed a bad pointer.  Resume at the access's fixup, which
+     reports the failure to its caller. */
+  if (!user && is_user_vaddr (fault_addr) && uaccess_fixup (f))
+    return;
+
   /* To implement virtual memory, delete the rest of the function
      body, and replace it with code that brings in the page to
      which fault_addr refers. */
@@ -19,6 +19,7 @@
 #include "threads/vaddr.h"
 
 #include "userprog/syscall.h" //Aggiunto
+#include "userprog/sysstat.h"
 
 static thread_func start_process NO_RETURN;
 static bool load (const char *cmdline, void (**eip) (void), void **esp);
@@ -176,6 +177,9 @@ process_exit (void)
   //Stampo un messaggio di uscita
   printf("%s: exit(%d)\n",cur->name,cur->exit_code);
 
+  //Stampo e libero le statistiche delle system call (solo con -sysstat)
+  sysstat_exit();
+
    /* Acquisisco il lock per garantire l'accesso esclusivo alla
   risorsa condivisa. Se il puntatore al file associato al thread
   corrente non  nullo, allora il thread corrente ha aperto un
@@ -532,6 +536,7 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
       read_bytes -= page_read_bytes;
       zero_bytes -= page_zero_bytes;
       upage += PGSIZE;
+      cond_resched ();
     }
   return true;
 }
@@ -7,7 +7,17 @@
 //Aggiunte
 #include "process.h"
 #include "threads/vaddr.h"
+#include "devices/input.h"
 #include "devices/shutdown.h"
+#include "threads/futex.h"
+#include "pagedir.h"
+#include "uaccess.h"
+#include "filesys/directory.h"
+#include "sysstat.h"
+#include "threads/latency.h"
+
+// Dimensione del buffer kernel usato per copiare i dati da e verso i buffer utente di read e write
+#define CHUNK_SIZE 256
 
 static void syscall_handler (struct intr_frame *);
 
@@ -20,9 +30,105 @@ void close(int fd);
 bool create(const char *file, unsigned initial_size);
 int read (int, void *, unsigned);
 int filesize (int fd);
-
-// Funzione per verificare se l'indirizzo è valido
-bool check (void *addr);
+int nice (int increment);
+void schedstat (struct schedstat *stats);
+bool setsched (int policy, int rt_priority, int quantum);
+int tickets (int new_tickets);
+bool setdeadline (int runtime, int period, int deadline);
+void latdump (void);
+int futex_wait (int *addr, int expected);
+int futex_wake (int *addr, int cnt);
+
+// Funzioni per leggere argomenti e stringhe dallo spazio utente
+static void get_args (const int *uargs, int *args, int cnt);
+static bool get_name (const char *ufile, char name[NAME_MAX + 2]);
+
+// Numero massimo di argomenti di una system call
+#define SYSCALL_MAX_ARGS 3
+
+// Tipo di un argomento, usato per stamparlo quando le system call vengono tracciate
+enum arg_type
+  {
+    ARG_INT,      //intero con segno (anche i file descriptor)
+    ARG_UINT,     //intero senza segno (dimensioni)
+    ARG_PTR,      //puntatore a un buffer utente
+    ARG_STR       //puntatore a una stringa utente
+  };
+
+// Tipo del valore restituito, che dice anche come riconoscere un errore
+enum ret_type
+  {
+    RET_VOID,     //non restituisce niente
+    RET_NORETURN, //non ritorna (halt, exit)
+    RET_INT,      //un intero qualsiasi, mai un errore (nice)
+    RET_ERR,      //un intero, negativo se c'è stato un errore
+    RET_BOOL      //un booleano, false se c'è stato un errore
+  };
+
+/* Descrizione di una system call nella tabella di dispatch: il gestore
+legge argc argomenti dallo stack utente e li passa a func, che chiama
+l'implementazione vera e propria con i tipi giusti. */
+struct syscall_desc
+  {
+    const char *name;                       //nome, per tracciamento e statistiche
+    int (*func) (const int *args);          //funzione che esegue la system call
+    int argc;                               //numero di argomenti
+    enum arg_type types[SYSCALL_MAX_ARGS];  //tipo di ogni argomento
+    enum ret_type ret;                      //tipo del valore restituito
+  };
+
+/* Se true, ogni system call viene stampata sulla console come fa strace,
+con argomenti e valore restituito. Viene impostato dall'opzione -strace. */
+bool syscall_trace;
+
+/* Se true, i processi utente possono passare a SCHED_FIFO o SCHED_RR.
+Di default è false, perché un processo real-time non cede mai la CPU
+ai thread del kernel (ksoftirqd, workqueue, task) con priorità più
+bassa. Viene impostato dall'opzione -user-rt. */
+bool syscall_user_rt;
+
+static void syscall_traced (struct intr_frame *f, int nr, const int *args);
+static void trace_call (int nr, const int *args);
+
+// Adattatori tra la tabella di dispatch e le implementazioni delle system call
+static int sys_halt (const int *a UNUSED) { halt(); NOT_REACHED(); }
+static int sys_exit (const int *a) { exit(a[0]); NOT_REACHED(); }
+static int sys_create (const int *a) { return create((const char *) a[0], a[1]); }
+static int sys_open (const int *a) { return open((const char *) a[0]); }
+static int sys_filesize (const int *a) { return filesize(a[0]); }
+static int sys_read (const int *a) { return read(a[0], (void *) a[1], a[2]); }
+static int sys_write (const int *a) { return write(a[0], (const void *) a[1], a[2]); }
+static int sys_close (const int *a) { close(a[0]); return 0; }
+static int sys_nice (const int *a) { return nice(a[0]); }
+static int sys_schedstat (const int *a) { schedstat((struct schedstat *) a[0]); return 0; }
+static int sys_setsched (const int *a) { return setsched(a[0], a[1], a[2]); }
+static int sys_tickets (const int *a) { return tickets(a[0]); }
+static int sys_setdeadline (const int *a) { return setdeadline(a[0], a[1], a[2]); }
+static int sys_latdump (const int *a UNUSED) { latdump(); return 0; }
+static int sys_futex_wait (const int *a) { return futex_wait((int *) a[0], a[1]); }
+static int sys_futex_wake (const int *a) { return futex_wake((int *) a[0], a[1]); }
+
+/* Tabella di dispatch, indicizzata dal numero della system call.
+I numeri senza implementazione hanno func == NULL. */
+static const struct syscall_desc syscalls[SYSSTAT_CNT] =
+  {
+    [SYS_HALT] = {"halt", sys_halt, 0, {}, RET_NORETURN},
+    [SYS_EXIT] = {"exit", sys_exit, 1, {ARG_INT}, RET_NORETURN},
+    [SYS_CREATE] = {"create", sys_create, 2, {ARG_STR, ARG_UINT}, RET_BOOL},
+    [SYS_OPEN] = {"open", sys_open, 1, {ARG_STR}, RET_ERR},
+    [SYS_FILESIZE] = {"filesize", sys_filesize, 1, {ARG_INT}, RET_ERR},
+    [SYS_READ] = {"read", sys_read, 3, {ARG_INT, ARG_PTR, ARG_UINT}, RET_ERR},
+    [SYS_WRITE] = {"write", sys_write, 3, {ARG_INT, ARG_PTR, ARG_UINT}, RET_ERR},
+    [SYS_CLOSE] = {"close", sys_close, 1, {ARG_INT}, RET_VOID},
+    [SYS_NICE] = {"nice", sys_nice, 1, {ARG_INT}, RET_INT},
+    [SYS_SCHEDSTAT] = {"schedstat", sys_schedstat, 1, {ARG_PTR}, RET_VOID},
+    [SYS_SETSCHED] = {"setsched", sys_setsched, 3, {ARG_INT, ARG_INT, ARG_INT}, RET_BOOL},
+    [SYS_TICKETS] = {"tickets", sys_tickets, 1, {ARG_INT}, RET_ERR},
+    [SYS_SETDEADLINE] = {"setdeadline", sys_setdeadline, 3, {ARG_INT, ARG_INT, ARG_INT}, RET_BOOL},
+    [SYS_LATDUMP] = {"latdump", sys_latdump, 0, {}, RET_VOID},
+    [SYS_FUTEX_WAIT] = {"futex_wait", sys_futex_wait, 2, {ARG_PTR, ARG_INT}, RET_ERR},
+    [SYS_FUTEX_WAKE] = {"futex_wake", sys_futex_wake, 2, {ARG_PTR, ARG_INT}, RET_INT},
+  };
 
 // Funzione per file descriptor
 struct file_desc *get_fd (int fd);
@@ -30,7 +136,7 @@ struct file_desc *get_fd (int fd);
 void
 syscall_init (void)
 {
-  lock_init(&file_lock); //Inizializzazione per sincronizzare l'accesso a risorse condivise ed evitare race conditions.
+  lock_init_named(&file_lock, "file_lock"); //Inizializzazione per sincronizzare l'accesso a risorse condivise ed evitare race conditions.
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
 }
 
@@ -38,78 +144,160 @@ static void
 syscall_handler (struct intr_frame *f)
 {
   int *ptr = f->esp;
-  if(check(ptr) == false)
+  int syscall_number;
+  int args[SYSCALL_MAX_ARGS]; //argomenti della system call, copiati dallo stack utente
+  const struct syscall_desc *sc;
+
+  /* Gli argomenti vengono copiati con copy_from_user, senza cercare le pagine
+  nella page directory: se un indirizzo non è valido, page_fault() lo segnala
+  e get_args termina il processo. */
+  get_args(ptr, &syscall_number, 1);
+  ASSERT(sizeof(syscall_number) == 4 ); // x86
+
+  if (syscall_number < 0 || syscall_number >= SYSSTAT_CNT
+      || syscalls[syscall_number].func == NULL)
+  {
+    // Numero System Call invalido, exit(-1) del processo
+    printf("Invalid System Call number\n");
     exit(-1);
+  }
+  sc = &syscalls[syscall_number];
 
-  int syscall_number = *ptr;
-  ASSERT(sizeof(syscall_number) == 4 ); // x86
+  /* Gli argomenti sono subito sopra il numero della system call, come li
+  mette sullo stack lib/user/syscall.c: l'argomento i è a ptr+1+i. */
+  get_args(ptr+1, args, sc->argc);
 
-  switch (syscall_number){
+  if (sysstat_enabled || syscall_trace) //strada lenta, con statistiche e tracciamento
+    syscall_traced(f, syscall_number, args);
+  else
+    f->eax = sc->func(args);
+}
 
-    case SYS_HALT:
-      halt();
-      break;
+/* Esegue la system call nr con gli argomenti args come syscall_handler,
+ma misura quanto dura, la conta nelle statistiche del processo se
+-sysstat è attivo e la stampa se -strace è attivo. */
+static void syscall_traced (struct intr_frame *f, int nr, const int *args)
+{
+  const struct syscall_desc *sc = &syscalls[nr];
+  uint64_t start;
+  bool error;
+  int ret;
 
-    case SYS_EXIT:
-        if(check(ptr+1)==false)
-            exit(-1);
+  if (sysstat_enabled)
+    sysstat_enter(nr); //va contata prima, perché exit e halt non ritornano
 
-        exit(*(ptr+1)); //exit ha 1 argomento --> ptr+1
+  if (syscall_trace && sc->ret == RET_NORETURN)
+  {
+    trace_call(nr, args);
+    printf(" = ?\n");
+  }
+
+  start = rdtsc();
+  ret = sc->func(args);
+  f->eax = ret;
+
+  error = (sc->ret == RET_ERR && ret < 0) || (sc->ret == RET_BOOL && !ret);
+  if (sysstat_enabled)
+    sysstat_leave(nr, rdtsc() - start, error);
+
+  if (syscall_trace)
+  {
+    trace_call(nr, args);
+    if (sc->ret == RET_VOID)
+      printf("\n");
+    else if (sc->ret == RET_BOOL)
+      printf(" = %s\n", ret ? "true" : "false");
+    else
+      printf(" = %d\n", ret);
+  }
+}
+
+/* Stampa la chiamata alla system call nr con gli argomenti args, nella forma
+"tid nome(arg, ...)". Delle stringhe stampa al massimo i primi caratteri. */
+static void trace_call (int nr, const int *args)
+{
+  const struct syscall_desc *sc = &syscalls[nr];
+  char str[24];
+  int i, len;
+
+  printf("strace: %d %s(", thread_current()->tid, sc->name);
+  for (i = 0; i < sc->argc; i++)
+  {
+    if (i > 0)
+      printf(", ");
+    switch (sc->types[i])
+    {
+      case ARG_INT:
+        printf("%d", args[i]);
         break;
 
-    case SYS_WRITE:
-        if (check(ptr+5)==false || check(ptr+6)==false ||
-        check (ptr+7)==false || check(*(ptr+6))==false)
-            exit(-1);
-        f->eax = write(*(ptr+5),*(ptr+6),*(ptr+7)); //write ha 3 argomenti--> ptr+5,6,7
+      case ARG_UINT:
+        printf("%u", (unsigned) args[i]);
         break;
 
-    case SYS_OPEN:
-      if(!check (ptr+1) || !check(*(ptr+1)))
-        exit(-1);
-      f->eax = open (*(ptr+1));//open ha 1 argomento --> ptr+1
-      break;
+      case ARG_PTR:
+        printf("%p", (void *) args[i]);
+        break;
 
-    case SYS_CLOSE:
-      if (!check(ptr+1))
-        exit(-1);
-      close(*(ptr+1));
-      break;
+      case ARG_STR:
+        len = strncpy_from_user(str, (const char *) args[i], sizeof str);
+        if (len < 0) //stringa non leggibile: stampo solo il puntatore
+          printf("%p", (void *) args[i]);
+        else if (len == (int) sizeof str) //stringa troncata
+          printf("\"%.*s\"...", (int) sizeof str, str);
+        else
+          printf("\"%s\"", str);
+        break;
+    }
+  }
+  printf(")");
+}
 
-    case SYS_CREATE:
-      if(!check(ptr+4) || !check(ptr+5) || !check(*(ptr+4)))
-        exit(-1);
-      f->eax = create (*(ptr+4), *(ptr+5));//write ha 2 argomenti--> ptr+4,5
-      break;
+// Restituisce il nome della system call nr, o "?" se non esiste
+const char *syscall_name (int nr)
+{
+  if (nr < 0 || nr >= SYSSTAT_CNT || syscalls[nr].name == NULL)
+    return "?";
+  return syscalls[nr].name;
+}
 
-     case SYS_READ:
-      if (!check(ptr+5) || !check (ptr+6) || !check (ptr+7) || !check (*(ptr+6)))
-        exit(-1);
-      f->eax=read(*(ptr+5),*(ptr+6),*(ptr+7));//read ha 3 argomenti--> ptr+5,6,7
-      break;
+// Copia cnt argomenti dallo stack utente (a partire da uargs) in args, termina il processo se non sono leggibili
+static void get_args (const int *uargs, int *args, int cnt)
+{
+  if (!copy_from_user(args, uargs, cnt * sizeof *args))
+    exit(-1);
+}
 
-    case SYS_FILESIZE:
-      if (!check(ptr+1))
-        exit(-1);
-      f->eax = filesize(*(ptr+1));//filesize ha 1 argomento --> ptr+1
-      break;
+/* Copia in name il nome di file utente ufile, terminando il processo se
+non è leggibile. Restituisce false se il nome è più lungo di NAME_MAX:
+nessun file può averlo, quindi non serve copiarlo tutto. */
+static bool get_name (const char *ufile, char name[NAME_MAX + 2])
+{
+  int len = strncpy_from_user(name, ufile, NAME_MAX + 2);
 
-    default:
-      // Numero System Call invalido, exit(-1) del processo
-      printf("Invalid System Call number\n");
-      exit(-1);
-      break;
-  }
+  if (len < 0)
+    exit(-1);
+  return len <= NAME_MAX;
 }
 
-// Funzione per verificare se l'indirizzo è valido
-bool check(void *addr) {
+// Copia size byte dal buffer utente usrc in dst; se il buffer non è valido rilascia il lock sui file e termina il processo
+static void copy_in_locked (void *dst, const void *usrc, size_t size)
+{
+  if (!copy_from_user(dst, usrc, size))
+  {
+    lock_release(&file_lock);
+    exit(-1);
+  }
+}
 
-    if (is_user_vaddr(addr) == true &&
-        pagedir_get_page(thread_current()->pagedir,addr)!=NULL)
-        return true;
-    else
-        return false;
+// Copia size byte da src nel buffer utente udst; se il buffer non è valido rilascia il lock sui file e termina il processo
+static void copy_out_locked (void *udst, const void *src, size_t size)
+{
+  if (!copy_to_user(udst, src, size))
+  {
+    lock_release(&file_lock);
+    exit(-1);
+  }
 }
 
 /* Implementazioni system calls */
@@ -122,9 +310,13 @@ void halt (void){
 /* Apre il file */
 int open(const char * file)
 {
-  // finire di implementare
+  char name[NAME_MAX + 2]; // copia kernel del nome del file
+
+  if (!get_name(file, name))  // un nome troppo lungo non corrisponde a nessun file
+    return -1;
+
   lock_acquire(&file_lock);  // acquisco il lock
-  struct file *file_p = filesys_open(file);   // apertura del file
+  struct file *file_p = filesys_open(name);   // apertura del file
   lock_release(&file_lock);  // rilascio del lock
 
   if(file_p == NULL)  // controllo se il file è stato aperto con successos
@@ -193,20 +385,33 @@ void exit (int status){
 int write (int fd, const void *buff, unsigned size){
 
     int num_bytes = -1; // Inizializzo il numero di byte scritti a -1
+    uint8_t kbuf[CHUNK_SIZE]; // Il buffer utente viene copiato qui un pezzo alla volta
+    unsigned chunk;
 
     lock_acquire(&file_lock); // Acquisisco il lock per garantire l'accesso esclusivo ai file.
 
     // STDOUT_FILENO‎ = 1 in lib/stdio.h
     if (fd == STDOUT_FILENO){ //Scrivo su standard output
-        putbuf(buff, size); //Scrivo il contenuto del buffer sulla console
-        num_bytes = size; // Imposto il numero di byte scritti come la dimensione del buffer
+        for (num_bytes = 0; (unsigned) num_bytes < size; num_bytes += chunk) {
+            chunk = size - num_bytes < CHUNK_SIZE ? size - num_bytes : CHUNK_SIZE;
+            copy_in_locked(kbuf, (const char *) buff + num_bytes, chunk);
+            putbuf((const char *) kbuf, chunk); //Scrivo il pezzo del buffer sulla console
+        }
     }
     else {
         struct file_desc *f_desc = get_fd(fd);
         if(f_desc == NULL)
             num_bytes = -1; // Se il file descriptor non esiste, inizializzo di nuovo a -1
-        else
-            num_bytes = file_write (f_desc->fp, buff, size); //file_write in filesys/file.c
+        else {
+            for (num_bytes = 0; (unsigned) num_bytes < size; ) {
+                chunk = size - num_bytes < CHUNK_SIZE ? size - num_bytes : CHUNK_SIZE;
+                copy_in_locked(kbuf, (const char *) buff + num_bytes, chunk);
+                int written = file_write (f_desc->fp, kbuf, chunk); //file_write in filesys/file.c
+                num_bytes += written;
+                if ((unsigned) written < chunk) // fine del file: non si può scrivere oltre
+                    break;
+            }
+        }
     }
 
     lock_release(&file_lock);
@@ -235,11 +440,13 @@ struct file_desc *get_fd (int fd) {
 //crea un nuono file|non lo apre
 bool create (const char * file, unsigned initial_size)
 {
-  if (file == NULL) //controlla se il nome del file è nullo
-    return -1;//restituisce un valore non valido (-1) se il nome del file è nullo
+  char name[NAME_MAX + 2]; //copia kernel del nome del file
+
+  if (!get_name(file, name)) //un nome troppo lungo non può essere creato
+    return false;
 
   lock_acquire(&file_lock); //acquisisce il lock per evitare conflitti dovuti alla concorrenza
-  int ret = filesys_create(file,initial_size); //Chiama la funzione di sistema filesys_create (filesys/filesys.c) per creare un nuovo file con il nome specificato e la dimensione iniziale specificata.
+  int ret = filesys_create(name,initial_size); //Chiama la funzione di sistema filesys_create (filesys/filesys.c) per creare un nuovo file con il nome specificato e la dimensione iniziale specificata.
   lock_release(&file_lock); //rilascia il lock
 
   return ret; //restituisce il valore di ritorno di filesys_create -> booleano di successo
@@ -249,13 +456,17 @@ bool create (const char * file, unsigned initial_size)
 int read (int fd, void * buffer, unsigned length)
 {
   unsigned int len =0; //variabile per tenere traccia della lunghezza effettiva letta
+  uint8_t kbuf[CHUNK_SIZE]; //i dati letti passano da qui prima di essere copiati nel buffer utente
+  unsigned chunk;
 
   if (fd == STDIN_FILENO) //Se il file descriptor è stdin (standard input)
   {
-    while (len < length) //Legge i byte da input_getc() fino a raggiungere la lunghezza specificata
+    while (len < length) //Legge i byte da input_read() a blocchi fino a raggiungere la lunghezza specificata
     {
-      *((char *)buffer+len) = input_getc();
-      len++;
+      chunk = input_read(kbuf, length - len < CHUNK_SIZE ? length - len : CHUNK_SIZE);
+      if (!copy_to_user((char *) buffer + len, kbuf, chunk))
+        exit(-1);
+      len += chunk;
     }
     return len; //restituisce la lunghezza effettiva leta
   }
@@ -269,7 +480,15 @@ int read (int fd, void * buffer, unsigned length)
   /*L'elemento è valido*/
 
   lock_acquire(&file_lock); //acquisisco il lock per evitare problematiche legate alla concorrenza
-  len = file_read(fd_elem->fp,buffer,length);//chiama la funzione di sistema file_read (filesys/file.c) per leggere il file
+  while (len < length) //legge il file a pezzi con file_read (filesys/file.c) e li copia nel buffer utente
+  {
+    chunk = length - len < CHUNK_SIZE ? length - len : CHUNK_SIZE;
+    unsigned got = file_read(fd_elem->fp, kbuf, chunk);
+    copy_out_locked((char *) buffer + len, kbuf, got);
+    len += got;
+    if (got < chunk) //fine del file
+      break;
+  }
   lock_release(&file_lock);//rilascia il lock
 
   return len; //restituisce la lunghezza effettiva letta dal file
@@ -289,3 +508,107 @@ int filesize (int fd)
   lock_release(&file_lock);//rilascio il lock
   return length;//ritorno la lunghezza del file
 }
+
+//modifica il valore nice del processo e restituisce il nuovo valore
+int nice (int increment)
+{
+  int new_nice = thread_get_nice() + increment; //nuovo valore richiesto
+
+  /* Come in Unix, un valore fuori dall'intervallo non è un errore:
+  viene riportato al limite più vicino. */
+  if (new_nice < NICE_MIN)
+    new_nice = NICE_MIN;
+  else if (new_nice > NICE_MAX)
+    new_nice = NICE_MAX;
+
+  thread_set_nice(new_nice); //ricalcola la priorità (con -o mlfqs) ed eventualmente cede la CPU
+  return new_nice;
+}
+
+//copia le statistiche di scheduling del processo nel buffer dell'utente
+void schedstat (struct schedstat *stats)
+{
+  /* Le statistiche vengono raccolte in una copia kernel e poi copiate
+  nel buffer utente, che può anche non essere valido. */
+  struct schedstat kstats;
+
+  thread_get_schedstat(thread_current(), &kstats);
+  if (!copy_to_user(stats, &kstats, sizeof kstats))
+    exit(-1);
+}
+
+//cambia la politica di scheduling del processo (SCHED_OTHER, SCHED_FIFO o SCHED_RR)
+bool setsched (int policy, int rt_priority, int quantum)
+{
+  /* Le politiche real-time sono riservate al kernel se non è stata
+  data l'opzione -user-rt. Gli altri argomenti vengono validati da
+  thread_set_policy, che restituisce false se la politica, la priorità
+  real-time o il quanto non sono validi. */
+  if ((policy == SCHED_FIFO || policy == SCHED_RR) && !syscall_user_rt)
+    return false;
+  return thread_set_policy(policy, rt_priority, quantum);
+}
+
+//imposta (se new_tickets non è 0) e restituisce i ticket del processo per lo scheduler stride
+int tickets (int new_tickets)
+{
+  /* Con new_tickets == 0 il numero di ticket viene solo letto.
+  A differenza di nice, un valore fuori dall'intervallo è un errore. */
+  if (new_tickets != 0)
+  {
+    if (new_tickets < TICKETS_MIN || new_tickets > TICKETS_MAX)
+      return -1;
+    thread_set_tickets(new_tickets); //ha effetto subito con -stride
+  }
+  return thread_get_tickets();
+}
+
+//passa il processo a SCHED_DEADLINE con budget runtime ogni period tick e scadenza relativa deadline
+bool setdeadline (int runtime, int period, int deadline)
+{
+  /* thread_set_deadline controlla che 0 < runtime <= deadline <= period
+  e fa il controllo di ammissione sulla banda totale: se fallisce
+  restituisce false e la politica del processo non cambia. */
+  return thread_set_deadline(runtime, period, deadline);
+}
+
+//stampa sulla console gli istogrammi delle latenze di risveglio, come allo spegnimento
+void latdump (void)
+{
+  latency_print_stats();
+}
+
+/* Restituisce l'indirizzo kernel dell'intero utente ADDR, che identifica
+il frame fisico e quindi la coda del futex anche se lo stesso frame è
+mappato a indirizzi diversi in più processi. Un indirizzo non allineato
+o non mappato termina il processo, come per gli altri puntatori non validi.
+Qui la page directory va consultata comunque, per trovare il frame. */
+static int *
+futex_kaddr (int *addr)
+{
+  int *kaddr = NULL;
+
+  if ((uintptr_t) addr % sizeof *addr == 0 && is_user_vaddr(addr))
+    kaddr = pagedir_get_page(thread_current()->pagedir, addr);
+  if (kaddr == NULL)
+    exit(-1);
+  return kaddr;
+}
+
+//dorme finché qualcuno chiama futex_wake su addr, ma solo se *addr vale ancora expected
+int futex_wait (int *addr, int expected)
+{
+  /* Restituisce 0 se il processo è stato svegliato, -1 se *addr non valeva
+  expected: in quel caso chi chiama deve ricontrollare il valore e riprovare. */
+  return futex_sleep(futex_kaddr(addr), expected) ? 0 : -1;
+}
+
+//sveglia al massimo cnt processi che dormono su addr e restituisce quanti ne ha svegliati
+int futex_wake (int *addr, int cnt)
+{
+  int *kaddr = futex_kaddr(addr);
+
+  if (cnt <= 0)
+    return 0;
+  return futex_wakeup(kaddr, cnt);
+}
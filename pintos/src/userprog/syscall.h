@@ -1,10 +1,19 @@
 #ifndef USERPROG_SYSCALL_H
 #define USERPROG_SYSCALL_H
 
+#include <stdbool.h>
 #include <stdio.h>
 #include "lib/kernel/list.h"
 
 void syscall_init (void);
+const char *syscall_name (int nr);
+
+/* Se true, le system call vengono stampate come fa strace (opzione -strace). */
+extern bool syscall_trace;
+
+/* Se true, i processi utente possono usare SCHED_FIFO e SCHED_RR
+(opzione -user-rt). */
+extern bool syscall_user_rt;
 
 /* Il file system non è implementato in Pintos in modo concorrente
 per cui mi serve un blocco per evitare che più thread accedano contemporaneamente
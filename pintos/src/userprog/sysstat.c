@@ -0,0 +1,171 @@
+#include "userprog/sysstat.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/latency.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+#include "userprog/syscall.h"
+
+/* If true, account for system calls. */
+bool sysstat_enabled;
+
+/* Totals over all processes, and latency histograms. */
+static struct sysstat_counter totals[SYSSTAT_CNT];
+static uint32_t hist[SYSSTAT_CNT][SYSSTAT_BUCKETS];
+
+static void count_leave (struct sysstat_counter *, uint64_t cycles,
+                         bool error);
+static int bucket (uint64_t cycles);
+static void print_counter (const char *name,
+                           const struct sysstat_counter *);
+static void print_cycles (uint64_t cycles);
+
+/* Counts a call to system call NR by the running process.  Must
+   be called before the call is carried out, because some system
+   calls do not return. */
+void
+sysstat_enter (int nr) 
+{
+  struct thread *t = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (nr >= 0 && nr < SYSSTAT_CNT);
+
+  /* Only the process itself touches its counts, so they need no
+     locking.  If there is no memory for them, only the totals
+     are kept. */
+  if (t->sysstat == NULL)
+    t->sysstat = calloc (1, sizeof *t->sysstat);
+  if (t->sysstat != NULL)
+    t->sysstat->counters[nr].calls++;
+
+  old_level = intr_disable ();
+  totals[nr].calls++;
+  intr_set_level (old_level);
+}
+
+/* Records that a call to system call NR by the running process
+   took CYCLES cycles and, if ERROR is true, that it failed. */
+void
+sysstat_leave (int nr, uint64_t cycles, bool error) 
+{
+  struct thread *t = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (nr >= 0 && nr < SYSSTAT_CNT);
+
+  if (t->sysstat != NULL)
+    count_leave (&t->sysstat->counters[nr], cycles, error);
+
+  old_level = intr_disable ();
+  count_leave (&totals[nr], cycles, error);
+  hist[nr][bucket (cycles)]++;
+  intr_set_level (old_level);
+}
+
+/* Prints the running process's counts, if it has any, and frees
+   them.  Called when the process exits. */
+void
+sysstat_exit (void) 
+{
+  struct thread *t = thread_current ();
+  int nr;
+
+  if (t->sysstat == NULL)
+    return;
+
+  printf ("Syscall: tid %d (%s):\n", t->tid, t->name);
+  for (nr = 0; nr < SYSSTAT_CNT; nr++)
+    if (t->sysstat->counters[nr].calls > 0)
+      print_counter (syscall_name (nr), &t->sysstat->counters[nr]);
+
+  free (t->sysstat);
+  t->sysstat = NULL;
+}
+
+/* Prints the totals over all processes, with their histograms,
+   if accounting is enabled. */
+void
+sysstat_print_stats (void) 
+{
+  enum intr_level old_level;
+  int nr;
+
+  if (!sysstat_enabled)
+    return;
+
+  old_level = intr_disable ();
+  printf ("Syscall: totals; bucket K counts calls that took 2**K cycles"
+          " or more\n");
+  for (nr = 0; nr < SYSSTAT_CNT; nr++)
+    if (totals[nr].calls > 0)
+      {
+        int lo, hi, k;
+
+        print_counter (syscall_name (nr), &totals[nr]);
+        for (lo = 0; lo < SYSSTAT_BUCKETS && hist[nr][lo] == 0; lo++)
+          continue;
+        for (hi = SYSSTAT_BUCKETS - 1; hi >= lo && hist[nr][hi] == 0; hi--)
+          continue;
+        if (lo > hi)
+          continue;
+        printf ("Syscall:   %-12s", "");
+        for (k = lo; k <= hi; k++)
+          printf (" %d:%"PRIu32, k, hist[nr][k]);
+        printf ("\n");
+      }
+  intr_set_level (old_level);
+}
+
+/* Adds a call that took CYCLES cycles, and failed if ERROR is
+   true, to C. */
+static void
+count_leave (struct sysstat_counter *c, uint64_t cycles, bool error) 
+{
+  if (error)
+    c->errors++;
+  c->total += cycles;
+  if (cycles > c->max)
+    c->max = cycles;
+}
+
+/* Returns the histogram bucket for CYCLES. */
+static int
+bucket (uint64_t cycles) 
+{
+  int k = 0;
+
+  while (cycles > 1 && k < SYSSTAT_BUCKETS - 1)
+    {
+      cycles >>= 1;
+      k++;
+    }
+  return k;
+}
+
+/* Prints C, the counts for the system call named NAME, on one
+   line. */
+static void
+print_counter (const char *name, const struct sysstat_counter *c) 
+{
+  printf ("Syscall:   %-12s %6"PRIu32" calls %6"PRIu32" errors, avg ",
+          name, c->calls, c->errors);
+  print_cycles (c->total / c->calls);
+  printf (", max ");
+  print_cycles (c->max);
+  printf ("\n");
+}
+
+/* Prints CYCLES, and the equivalent in microseconds if the
+   time-stamp counter has been calibrated. */
+static void
+print_cycles (uint64_t cycles) 
+{
+  uint64_t cycles_per_us = latency_cycles_per_us ();
+
+  printf ("%"PRIu64" cycles", cycles);
+  if (cycles_per_us != 0)
+    printf (" (%"PRIu64" us)", cycles / cycles_per_us);
+}
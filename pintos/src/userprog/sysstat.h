@@ -0,0 +1,49 @@
+#ifndef USERPROG_SYSSTAT_H
+#define USERPROG_SYSSTAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <syscall-nr.h>
+
+/* System call accounting.
+
+   With the -sysstat option, the system call handler counts the
+   calls each process makes to each system call, how many of them
+   failed, and how long they took, in time-stamp counter cycles.
+   A process's counts are printed when it exits.  Totals over all
+   processes, with a log2 histogram of latencies per system call,
+   are printed at shutdown.  Without the option, none of this
+   costs anything beyond testing a flag. */
+
+/* Number of system call numbers. */
+#define SYSSTAT_CNT (SYS_FUTEX_WAKE + 1)
+
+/* Number of histogram buckets.  Bucket K counts calls that took
+   2**K to 2**(K+1) - 1 cycles, except that bucket 0 also counts
+   0 cycles and the last bucket counts everything longer. */
+#define SYSSTAT_BUCKETS 32
+
+/* Counts for one system call. */
+struct sysstat_counter
+  {
+    uint32_t calls;             /* Number of calls. */
+    uint32_t errors;            /* Number of calls that failed. */
+    uint64_t total;             /* Total cycles in calls that returned. */
+    uint64_t max;               /* Longest call, in cycles. */
+  };
+
+/* Counts for one process, allocated on its first system call. */
+struct sysstat
+  {
+    struct sysstat_counter counters[SYSSTAT_CNT];
+  };
+
+/* If true, account for system calls.  Set by -sysstat. */
+extern bool sysstat_enabled;
+
+void sysstat_enter (int nr);
+void sysstat_leave (int nr, uint64_t cycles, bool error);
+void sysstat_exit (void);
+void sysstat_print_stats (void);
+
+#endif /* userprog/sysstat.h */
@@ -0,0 +1,122 @@
+#include "userprog/uaccess.h"
+#include <debug.h>
+#include <stdint.h>
+#include "threads/vaddr.h"
+
+/* Exception table entry.  If the instruction at INSN faults on a
+   user address, execution resumes at FIXUP. */
+struct ex_entry
+  {
+    uintptr_t insn;             /* Address of a user access. */
+    uintptr_t fixup;            /* Where to resume if it faults. */
+  };
+
+/* The exception table.  Each user access below adds an entry to
+   the __ex_table section, and the linker script
+   (threads/kernel.lds.S) gathers them between these symbols. */
+extern const struct ex_entry _start_ex_table[], _end_ex_table[];
+
+/* Returns true if the SIZE bytes starting at UADDR all lie in
+   user virtual memory, false otherwise. */
+static bool
+user_range_ok (const void *uaddr, size_t size) 
+{
+  uintptr_t start = (uintptr_t) uaddr;
+  uintptr_t limit = (uintptr_t) PHYS_BASE;
+
+  return start <= limit && size <= limit - start;
+}
+
+/* Copies SIZE bytes from SRC to DST and returns the number of
+   bytes not copied.  If REP MOVSB faults, page_fault() resumes
+   just past it, with ECX still holding the count of bytes left. */
+static size_t
+copy_user (void *dst, const void *src, size_t size) 
+{
+  asm volatile ("1: rep movsb\n"
+                "2:\n"
+                ".section __ex_table, \"a\"\n"
+                "  .long 1b, 2b\n"
+                ".previous"
+                : "+c" (size), "+D" (dst), "+S" (src) : : "memory");
+  return size;
+}
+
+/* Reads a byte at user virtual address UADDR, which must be below
+   PHYS_BASE.  Returns the byte value if successful, -1 if the
+   read faults.  A faulting MOVZBL leaves -1 in the result. */
+static int
+get_user (const uint8_t *uaddr) 
+{
+  int result;
+
+  asm volatile ("movl $-1, %0\n"
+                "1: movzbl %1, %0\n"
+                "2:\n"
+                ".section __ex_table, \"a\"\n"
+                "  .long 1b, 2b\n"
+                ".previous"
+                : "=&r" (result) : "m" (*uaddr));
+  return result;
+}
+
+/* Copies SIZE bytes from user address USRC to kernel address
+   DST.  Returns true if successful, false if any of the source
+   bytes is not in mapped user memory. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size) 
+{
+  return user_range_ok (usrc, size) && copy_user (dst, usrc, size) == 0;
+}
+
+/* Copies SIZE bytes from kernel address SRC to user address
+   UDST.  Returns true if successful, false if any of the
+   destination bytes is not in mapped user memory. */
+bool
+copy_to_user (void *udst, const void *src, size_t size) 
+{
+  return user_range_ok (udst, size) && copy_user (udst, src, size) == 0;
+}
+
+/* Copies the null-terminated string at user address USRC into
+   DST, which has room for SIZE bytes.  Returns the length of the
+   string, not counting the null terminator, if it fits.  Returns
+   SIZE if no null terminator is found in the first SIZE bytes,
+   in which case DST is not null-terminated.  Returns -1 if a
+   byte to be copied is not in mapped user memory. */
+int
+strncpy_from_user (char *dst, const char *usrc, size_t size) 
+{
+  const uint8_t *src = (const uint8_t *) usrc;
+  size_t i;
+
+  for (i = 0; i < size; i++) 
+    {
+      int c;
+
+      if (!is_user_vaddr (src + i) || (c = get_user (src + i)) < 0)
+        return -1;
+      dst[i] = c;
+      if (c == '\0')
+        return i;
+    }
+  return size;
+}
+
+/* Called by page_fault() for a fault in kernel context on a user
+   address.  If the faulting instruction is in the exception
+   table, redirects F to its fixup and returns true.  Otherwise
+   returns false, since the fault is a kernel bug. */
+bool
+uaccess_fixup (struct intr_frame *f) 
+{
+  const struct ex_entry *e;
+
+  for (e = _start_ex_table; e < _end_ex_table; e++)
+    if (e->insn == (uintptr_t) f->eip) 
+      {
+        f->eip = (void (*) (void)) e->fixup;
+        return true;
+      }
+  return false;
+}
@@ -0,0 +1,23 @@
+#ifndef USERPROG_UACCESS_H
+#define USERPROG_UACCESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "threads/interrupt.h"
+
+/* Access to user memory from the kernel.
+
+   These functions do not look up user pages in the page
+   directory before touching them.  They check only that the
+   addresses lie below PHYS_BASE and then access the memory
+   directly.  If an access faults, page_fault() finds the
+   faulting instruction in the exception table and resumes at its
+   fixup, and the function reports failure. */
+
+bool copy_from_user (void *dst, const void *usrc, size_t size);
+bool copy_to_user (void *udst, const void *src, size_t size);
+int strncpy_from_user (char *dst, const char *usrc, size_t size);
+
+bool uaccess_fixup (struct intr_frame *);
+
+#endif /* userprog/uaccess.h */